@@ -4,6 +4,7 @@
 
 extern "C" {
 #include "readlinex.h"
+#include <getopt.h>
 #include <string.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -15,6 +16,7 @@ extern "C" {
 #include <sys/stat.h>
 #include <sys/wait.h>
 }
+#include <chrono>
 #include <iostream>
 #include <fstream>
 
@@ -28,12 +30,14 @@ extern "C" {
 #include <curv/file.h>
 #include <curv/parser.h>
 #include <curv/phrase.h>
+#include <curv/printer.h>
 #include <curv/shared.h>
 #include <curv/system.h>
 #include <curv/list.h>
 #include <curv/record.h>
 #include <curv/gl_compiler.h>
 #include <curv/shape.h>
+#include <curv/trace.h>
 #include <curv/version.h>
 #include <curv/die.h>
 
@@ -70,10 +74,14 @@ struct CString_Script : public curv::Script
 };
 
 curv::System&
-make_system(const char* argv0, std::list<const char*>& libs)
+make_system(const char* argv0, std::list<const char*>& libs,
+    std::list<const char*>& plugins)
 {
     try {
         static curv::System_Impl sys(std::cerr);
+        for (const char* plugin : plugins) {
+            sys.load_plugin(curv::make_string(plugin));
+        }
         if (argv0 != nullptr) {
             const char* CURV_STDLIB = getenv("CURV_STDLIB");
             namespace fs = boost::filesystem;
@@ -200,7 +208,8 @@ launch_viewer(curv::Shared<curv::String> filename)
 
 bool
 display_shape(curv::Value value,
-    curv::System& sys, const curv::Context &cx, bool block = false)
+    curv::System& sys, const curv::Context &cx, bool block = false,
+    double* gl_time = nullptr)
 {
     curv::Shape_Recognizer shape(cx, sys);
     if (shape.recognize(value)) {
@@ -216,7 +225,11 @@ display_shape(curv::Value value,
 
         auto filename = make_tempfile();
         std::ofstream f(filename->c_str());
+        auto start = std::chrono::steady_clock::now();
         curv::gl_compile(shape, f, cx);
+        auto end = std::chrono::steady_clock::now();
+        if (gl_time)
+            *gl_time = std::chrono::duration<double>(end - start).count();
         f.close();
         if (block) {
             auto cmd = curv::stringify("glslViewer ",filename->c_str(),
@@ -231,6 +244,22 @@ display_shape(curv::Value value,
         return false;
 }
 
+// Number of characters of each result that the REPL prints by default.
+constexpr size_t repl_print_limit = 10'000;
+
+// If `line` begins with the REPL command `cmd`, remove it and return true.
+bool
+repl_command(char* line, const char* cmd)
+{
+    size_t n = strlen(cmd);
+    if (strncmp(line, cmd, n) != 0 || (line[n] != ' ' && line[n] != '\0'))
+        return false;
+    while (line[n] == ' ')
+        ++n;
+    memmove(line, line+n, strlen(line+n)+1);
+    return true;
+}
+
 int
 interactive_mode(curv::System& sys)
 {
@@ -256,11 +285,30 @@ interactive_mode(curv::System& sys)
             }
             return EXIT_SUCCESS;
         }
+        // `:time expr` reports the evaluation time and allocation count,
+        // and the GL compile time if the result is a shape.
+        // `:full expr` prints the whole result. Otherwise, results are
+        // cut short after repl_print_limit characters.
+        bool timing = false;
+        bool full = false;
+        for (;;) {
+            if (repl_command(line, ":time"))
+                timing = true;
+            else if (repl_command(line, ":full"))
+                full = true;
+            else
+                break;
+        }
         auto script = curv::make<CString_Script>("", line);
         try {
+            auto start = std::chrono::steady_clock::now();
+            auto allocs = curv::shared_alloc_count.load();
             curv::Program prog{*script, sys};
             prog.compile(&names, nullptr);
             auto den = prog.denotes();
+            allocs = curv::shared_alloc_count.load() - allocs;
+            auto end = std::chrono::steady_clock::now();
+            double gl_time = -1.0;
             if (den.first) {
                 for (auto f : *den.first)
                     names[f.first] = curv::make<curv::Builtin_Value>(f.second);
@@ -272,13 +320,29 @@ interactive_mode(curv::System& sys)
                     names[lastval_key] =
                         curv::make<curv::Builtin_Value>(den.second->front());
                     is_shape = display_shape(den.second->front(),
-                        sys, curv::At_Phrase(prog.value_phrase(), nullptr));
+                        sys, curv::At_Phrase(prog.value_phrase(), nullptr),
+                        false, &gl_time);
                 }
                 if (!is_shape) {
-                    for (auto e : *den.second)
-                        std::cout << e << "\n";
+                    for (auto e : *den.second) {
+                        curv::Value_Printer pr(std::cout,
+                            full ? 0 : repl_print_limit);
+                        pr.print(e);
+                        pr.flush();
+                        if (pr.truncated())
+                            std::cout << "\n(output truncated: use :full)";
+                        std::cout << "\n";
+                    }
                 }
             }
+            if (timing) {
+                std::cout << "eval "
+                    << std::chrono::duration<double>(end - start).count()
+                    << "s, " << allocs << " allocations";
+                if (gl_time >= 0.0)
+                    std::cout << ", GL compile " << gl_time << "s";
+                std::cout << "\n";
+            }
         } catch (curv::Exception& e) {
             std::cout << "ERROR: " << e << "\n";
         } catch (std::exception& e) {
@@ -341,6 +405,7 @@ const char help[] =
 "curv [options] [filename]\n"
 "-n -- don't use standard library\n"
 "-i file -- include specified library; may be repeated\n"
+"-p file -- load native plugin (shared library); may be repeated\n"
 "-l -- live programming mode\n"
 "-e -- run <$CURV_EDITOR filename> in live mode\n"
 "-x -- interpret filename argument as expression\n"
@@ -351,13 +416,27 @@ const char help[] =
 "   stl -- STL mesh file (3D shape only)\n"
 "   obj -- OBJ mesh file (3D shape only)\n"
 "   x3d -- X3D colour mesh file (3D shape only)\n"
+"   points -- surface point cloud with normals (3D shape only)\n"
 "   png -- PNG image file (shape only)\n"
 "-O name=value -- parameter for one of the output formats\n"
+"-O compress=gzip|zstd -- compress the output of any format\n"
+"--trace file -- write a timeline of the run to file, in Chrome trace format\n"
 "--version -- display version.\n"
 "--help -- display this help information.\n"
 "filename -- input file, a Curv script. Interactive CLI if missing.\n"
 ;
 
+const char* trace_filename = nullptr;
+
+void
+write_trace()
+{
+    std::ofstream out(trace_filename);
+    curv::trace_write(out);
+    if (!out)
+        std::cerr << "can't write trace file " << trace_filename << "\n";
+}
+
 int
 main(int argc, char** argv)
 {
@@ -379,11 +458,18 @@ main(int argc, char** argv)
     Export_Params eparams;
     bool live = false;
     std::list<const char*> libs;
+    std::list<const char*> plugins;
     bool expr = false;
     const char* editor = nullptr;
 
+    static const struct option long_options[] = {
+        {"trace", required_argument, nullptr, 'T'},
+        {nullptr, 0, nullptr, 0}
+    };
     int opt;
-    while ((opt = getopt(argc, argv, ":o:O:lni:xe")) != -1) {
+    while ((opt = getopt_long(argc, argv, ":o:O:lni:p:xe", long_options,
+            nullptr)) != -1)
+    {
         switch (opt) {
         case 'o':
             if (strcmp(optarg, "curv") == 0)
@@ -398,6 +484,8 @@ main(int argc, char** argv)
                 exporter = export_obj;
             else if (strcmp(optarg, "x3d") == 0)
                 exporter = export_x3d;
+            else if (strcmp(optarg, "points") == 0)
+                exporter = export_points;
             else if (strcmp(optarg, "png") == 0)
                 exporter = export_png;
             else {
@@ -427,9 +515,15 @@ main(int argc, char** argv)
         case 'i':
             libs.push_back(optarg);
             break;
+        case 'p':
+            plugins.push_back(optarg);
+            break;
         case 'x':
             expr = true;
             break;
+        case 'T':
+            trace_filename = optarg;
+            break;
         case 'e':
             editor = getenv("CURV_EDITOR");
             if (editor == nullptr) {
@@ -443,7 +537,11 @@ main(int argc, char** argv)
                      << "Use " << argv0 << " --help for help.\n";
             return EXIT_FAILURE;
         case ':':
-            std::cerr << "-" << (char)optopt << ": missing argument\n"
+            if (optopt == 'T')
+                std::cerr << "--trace";
+            else
+                std::cerr << "-" << (char)optopt;
+            std::cerr << ": missing argument\n"
                      << "Use " << argv0 << " --help for help.\n";
             return EXIT_FAILURE;
         default:
@@ -480,6 +578,19 @@ main(int argc, char** argv)
             return EXIT_FAILURE;
         }
     }
+    auto compress_p = eparams.find("compress");
+    if (compress_p != eparams.end()) {
+        if (exporter == nullptr) {
+            std::cerr << "-O compress specified without -o flag.\n"
+                      << "Use " << argv0 << " --help for help.\n";
+            return EXIT_FAILURE;
+        }
+        if (!is_compression_method(compress_p->second)) {
+            std::cerr << "-O compress=" << compress_p->second
+                      << ": expecting gzip or zstd\n";
+            return EXIT_FAILURE;
+        }
+    }
     if (editor && !live) {
         std::cerr << "-e flag specified without -l flag.\n"
                   << "Use " << argv0 << " --help for help.\n";
@@ -487,7 +598,11 @@ main(int argc, char** argv)
     }
 
     // Interpret arguments
-    curv::System& sys(make_system(argv0, libs));
+    if (trace_filename) {
+        curv::trace_start();
+        atexit(write_trace);
+    }
+    curv::System& sys(make_system(argv0, libs, plugins));
     atexit(remove_tempfile);
 
     if (filename == nullptr) {
@@ -509,8 +624,15 @@ main(int argc, char** argv)
         }
 
         curv::Program prog{*script, sys};
-        prog.compile();
-        auto value = prog.eval();
+        {
+            curv::Trace_Scope trace("compile");
+            prog.compile();
+        }
+        curv::Value value;
+        {
+            curv::Trace_Scope trace("eval");
+            value = prog.eval();
+        }
 
         if (exporter == nullptr) {
             if (!display_shape(value,
@@ -521,11 +643,23 @@ main(int argc, char** argv)
                 std::cout << value << "\n";
             }
         } else {
+            curv::Trace_Scope trace("export");
+            // With -O compress, the exporter writes through a compressor
+            // as it goes, so the uncompressed output is never stored.
+            boost::iostreams::filtering_ostream zout;
+            std::ostream* out = &std::cout;
+            if (compress_p != eparams.end()) {
+                push_compressor(zout, compress_p->second);
+                zout.push(std::cout);
+                out = &zout;
+            }
             exporter(value,
                 sys,
                 curv::At_Phrase(prog.value_phrase(), nullptr),
                 eparams,
-                std::cout);
+                *out);
+            // Flush the compressor and write the trailer.
+            zout.reset();
         }
     } catch (curv::Exception& e) {
         std::cerr << "ERROR: " << e << "\n";
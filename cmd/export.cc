@@ -4,14 +4,69 @@
 
 #include "export.h"
 #include <fstream>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <curv/die.h>
 #include <curv/exception.h>
+#include <curv/printer.h>
 #include <curv/shape.h>
 
+double param_to_double(Export_Params::const_iterator i)
+{
+    char *endptr;
+    double result = strtod(i->second.c_str(), &endptr);
+    if (endptr == i->second.c_str() || result != result) {
+        // error
+        std::cerr << "invalid number in: -O "<< i->first.c_str() << "='"
+            << i->second.c_str() << "'\n";
+        exit(EXIT_FAILURE);
+    }
+    return result;
+}
+
+bool param_to_bool(Export_Params::const_iterator i)
+{
+    const std::string& s = i->second;
+    if (s.empty() || s == "true" || s == "1")
+        return true;
+    if (s == "false" || s == "0")
+        return false;
+    std::cerr << "invalid boolean in: -O "<< i->first.c_str() << "='"
+        << s.c_str() << "'\n";
+    exit(EXIT_FAILURE);
+}
+
+bool is_compression_method(const std::string& method)
+{
+    return method == "gzip" || method == "zstd";
+}
+
+void push_compressor(
+    boost::iostreams::filtering_ostream& out, const std::string& method)
+{
+    if (method == "gzip")
+        out.push(boost::iostreams::gzip_compressor());
+    else if (method == "zstd")
+        out.push(boost::iostreams::zstd_compressor());
+    else
+        curv::die("push_compressor: bad compression method");
+}
+
+const char* compression_suffix(const std::string& method)
+{
+    if (method == "gzip")
+        return ".gz";
+    if (method == "zstd")
+        return ".zst";
+    curv::die("compression_suffix: bad compression method");
+}
+
 void export_curv(curv::Value value,
     curv::System&, const curv::Context&, const Export_Params&,
     std::ostream& out)
 {
-    out << value << "\n";
+    curv::Value_Printer(out).print(value);
+    out << "\n";
 }
 
 void export_frag(curv::Value value,
@@ -27,6 +82,8 @@ void export_frag(curv::Value value,
 
 bool is_json_data(curv::Value val)
 {
+    if (val.is_inline_string())
+        return true;
     if (val.is_ref()) {
         auto& ref = val.get_ref_unsafe();
         switch (ref.type_) {
@@ -55,12 +112,7 @@ bool export_json_value(curv::Value val, std::ostream& out)
         out << curv::dfmt(val.get_num_unsafe(), curv::dfmt::JSON);
         return true;
     }
-    assert(val.is_ref());
-    auto& ref = val.get_ref_unsafe();
-    switch (ref.type_) {
-    case curv::Ref_Value::ty_string:
-      {
-        auto& str = (curv::String&)ref;
+    if (auto str = curv::String_Ref(val)) {
         out << '"';
         for (auto c : str) {
             if (c == '\\' || c == '"')
@@ -69,7 +121,10 @@ bool export_json_value(curv::Value val, std::ostream& out)
         }
         out << '"';
         return true;
-      }
+    }
+    assert(val.is_ref());
+    auto& ref = val.get_ref_unsafe();
+    switch (ref.type_) {
     case curv::Ref_Value::ty_list:
       {
         auto& list = (curv::List&)ref;
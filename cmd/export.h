@@ -11,9 +11,27 @@
 #include <curv/value.h>
 #include <curv/system.h>
 #include <curv/context.h>
+#include <boost/iostreams/filtering_stream.hpp>
 
 typedef std::map<std::string, std::string> Export_Params;
 
+// Parse the value of a -O parameter as a number, or exit with an error.
+extern double param_to_double(Export_Params::const_iterator);
+
+// Parse the value of a -O parameter as a boolean, or exit with an error.
+// `-O name` with no value is true.
+extern bool param_to_bool(Export_Params::const_iterator);
+
+// True if `method` is a valid argument for `-O compress=method`.
+extern bool is_compression_method(const std::string& method);
+
+// Push a compressor for `-O compress=method` onto the filter chain.
+extern void push_compressor(
+    boost::iostreams::filtering_ostream&, const std::string& method);
+
+// The file name suffix for `-O compress=method`: ".gz" or ".zst".
+extern const char* compression_suffix(const std::string& method);
+
 extern void export_curv(curv::Value value,
     curv::System&, const curv::Context&, const Export_Params& params,
     std::ostream& out);
@@ -30,6 +48,10 @@ extern void export_x3d(curv::Value,
     curv::System&, const curv::Context&, const Export_Params& params,
     std::ostream&);
 
+extern void export_points(curv::Value,
+    curv::System&, const curv::Context&, const Export_Params& params,
+    std::ostream&);
+
 extern void export_frag(curv::Value value,
     curv::System&, const curv::Context& cx, const Export_Params& params,
     std::ostream& out);
@@ -3,16 +3,30 @@
 // See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <chrono>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
 #include <openvdb/openvdb.h>
+#include <openvdb/tools/GridTransformer.h>
+#include <openvdb/tools/LevelSetRebuild.h>
+#include <openvdb/tools/Prune.h>
 #include <openvdb/tools/VolumeToMesh.h>
 
 #include "export.h"
 #include <curv/shape.h>
 #include <curv/exception.h>
 #include <curv/die.h>
+#include <curv/trace.h>
 
 using openvdb::Vec3s;
 using openvdb::Vec3d;
@@ -68,17 +82,268 @@ void put_colour(std::ostream& out, curv::Shape_Recognizer& shape,
     out << " " << c.x << " " << c.y << " " << c.z;
 }
 
-double param_to_double(Export_Params::const_iterator i)
+struct Mesh_Stats
 {
-    char *endptr;
-    double result = strtod(i->second.c_str(), &endptr);
-    if (endptr == i->second.c_str() || result != result) {
-        // error
-        std::cerr << "invalid number in: -O "<< i->first.c_str() << "='"
-            << i->second.c_str() << "'\n";
-        exit(EXIT_FAILURE);
+    int64_t ntri = 0;
+    int64_t nquad = 0;
+};
+
+struct Level_Of_Detail
+{
+    // The voxel size is `factor` times the voxel size of the finest grid.
+    int factor;
+    openvdb::FloatGrid::Ptr grid;
+    std::unique_ptr<openvdb::tools::VolumeToMesh> mesher;
+};
+
+const char* format_extension(Mesh_Format format)
+{
+    switch (format) {
+    case stl_format: return ".stl";
+    case obj_format: return ".obj";
+    case x3d_format: return ".x3d";
+    default:
+        curv::die("bad mesh format");
+    }
+}
+
+// Parse `-O lod=F1,F2,...`, a list of integer coarsening factors > 1.
+// The factors are returned in increasing order, without duplicates, so that
+// each level of detail is meshed and written once, finest first.
+std::vector<int> parse_lod_factors(
+    Export_Params::const_iterator p, const curv::Context& cx)
+{
+    std::vector<int> factors;
+    const char* str = p->second.c_str();
+    for (;;) {
+        char* end;
+        long f = strtol(str, &end, 10);
+        if (end == str || f < 2 || f > 1024 || (*end != ',' && *end != '\0')) {
+            throw curv::Exception(cx, curv::stringify(
+                "mesh export: invalid parameter lod=",p->second.c_str(),
+                ": expecting a list of integer factors > 1, like lod=2,4,8"));
+        }
+        factors.push_back(int(f));
+        if (*end == '\0')
+            break;
+        str = end + 1;
+    }
+    std::sort(factors.begin(), factors.end());
+    factors.erase(std::unique(factors.begin(), factors.end()), factors.end());
+    return factors;
+}
+
+// Format `nchunks` chunks of output in parallel, each into its own buffer,
+// then write the buffers to `out` in order. `format(i, buf)` formats chunk i.
+// Chunks are processed in batches, which bounds the memory used by buffers.
+// `sep` is written between nonempty chunks.
+template <class Format>
+void write_chunks(std::ostream& out, size_t nchunks, Format format,
+    const char* sep = "")
+{
+    size_t nthreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t batch = 4 * nthreads;
+    std::vector<std::ostringstream> bufs(std::min(batch, nchunks));
+    bool first = true;
+    for (size_t base = 0; base < nchunks; base += batch) {
+        size_t n = std::min(batch, nchunks - base);
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t k; (k = next++) < n; ) {
+                bufs[k].str("");
+                format(base + k, bufs[k]);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < std::min(nthreads, n); ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& t : threads)
+            t.join();
+        for (size_t k = 0; k < n; ++k) {
+            std::string str = bufs[k].str();
+            if (str.empty())
+                continue;
+            if (!first)
+                out << sep;
+            first = false;
+            out << str;
+        }
+    }
+}
+
+// Write the mesh in the given format.
+// The polygon pools are formatted in parallel by write_chunks. Vertex
+// indexes in the pools are global, so chunks can be formatted
+// independently. X3D colours are computed sequentially, since they call
+// the evaluator.
+Mesh_Stats write_mesh(Mesh_Format format,
+    openvdb::tools::VolumeToMesh& mesher,
+    curv::Shape_Recognizer& shape, std::ostream& out)
+{
+    constexpr size_t points_per_chunk = 16384;
+    size_t npools = mesher.polygonPoolListSize();
+    size_t npoints = mesher.pointListSize();
+    size_t npoint_chunks = (npoints + points_per_chunk - 1) / points_per_chunk;
+    auto& points = mesher.pointList();
+    auto& pools = mesher.polygonPoolList();
+
+    Mesh_Stats st;
+    for (size_t i = 0; i < npools; ++i) {
+        st.ntri += pools[i].numTriangles();
+        st.nquad += pools[i].numQuads();
+    }
+    if (format != obj_format) {
+        // quads are split into triangles
+        st.ntri += 2 * st.nquad;
+        st.nquad = 0;
+    }
+
+    switch (format) {
+    case stl_format:
+        out << "solid curv\n";
+        write_chunks(out, npools, [&](size_t i, std::ostream& buf) {
+            openvdb::tools::PolygonPool& pool = pools[i];
+            for (size_t j=0; j<pool.numTriangles(); ++j) {
+                // swap ordering of nodes to get outside-normals
+                put_triangle(buf,
+                    points[ pool.triangle(j)[0] ],
+                    points[ pool.triangle(j)[2] ],
+                    points[ pool.triangle(j)[1] ]);
+            }
+            for (size_t j=0; j<pool.numQuads(); ++j) {
+                // swap ordering of nodes to get outside-normals
+                put_triangle(buf,
+                    points[ pool.quad(j)[0] ],
+                    points[ pool.quad(j)[2] ],
+                    points[ pool.quad(j)[1] ]);
+                put_triangle(buf,
+                    points[ pool.quad(j)[0] ],
+                    points[ pool.quad(j)[3] ],
+                    points[ pool.quad(j)[2] ]);
+            }
+        });
+        out << "endsolid curv\n";
+        break;
+    case obj_format:
+        write_chunks(out, npoint_chunks, [&](size_t c, std::ostream& buf) {
+            size_t end = std::min(npoints, (c+1) * points_per_chunk);
+            for (size_t i = c * points_per_chunk; i < end; ++i) {
+                auto& pt = points[i];
+                buf << "v " << pt.x() << " " << pt.y() << " " << pt.z() << "\n";
+            }
+        });
+        write_chunks(out, npools, [&](size_t i, std::ostream& buf) {
+            openvdb::tools::PolygonPool& pool = pools[i];
+            for (size_t j=0; j<pool.numTriangles(); ++j) {
+                // swap ordering of nodes to get outside-normals
+                auto& tri = pool.triangle(j);
+                buf << "f " << tri[0]+1 << " "
+                            << tri[2]+1 << " "
+                            << tri[1]+1 << "\n";
+            }
+            for (size_t j=0; j<pool.numQuads(); ++j) {
+                // swap ordering of nodes to get outside-normals
+                auto& q = pool.quad(j);
+                buf << "f " << q[0]+1 << " "
+                            << q[3]+1 << " "
+                            << q[2]+1 << " "
+                            << q[1]+1 << "\n";
+            }
+        });
+        break;
+    case x3d_format:
+      {
+        out <<
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!DOCTYPE X3D PUBLIC \"ISO//Web3D//DTD X3D 3.1//EN\" \"http://www.web3d.org/specifications/x3d-3.1.dtd\">\n"
+        "<X3D profile=\"Interchange\" version=\"3.1\" xsd:noNamespaceSchemaLocation=\"http://www.web3d.org/specifications/x3d-3.1.xsd\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
+        " <head>\n"
+        "  <meta content=\"Curv, https://github.com/doug-moen/curv\" name=\"generator\"/>\n"
+        " </head>\n"
+        " <Scene>\n"
+        "  <Shape>\n"
+        "   <IndexedFaceSet colorPerVertex=\"false\" coordIndex=\"";
+        write_chunks(out, npools, [&](size_t i, std::ostream& buf) {
+            openvdb::tools::PolygonPool& pool = pools[i];
+            bool first = true;
+            for (size_t j=0; j<pool.numTriangles(); ++j) {
+                if (!first) buf << " "; first = false;
+                auto& tri = pool.triangle(j);
+                buf << tri[0] << " " << tri[2] << " " << tri[1] << " -1";
+            }
+            for (size_t j=0; j<pool.numQuads(); ++j) {
+                if (!first) buf << " "; first = false;
+                auto& q = pool.quad(j);
+                buf << q[0] << " " << q[2] << " " << q[1] << " -1 "
+                    << q[0] << " " << q[3] << " " << q[2] << " -1";
+            }
+        }, " ");
+        out <<
+        "\">\n"
+        "    <Coordinate point=\"";
+        write_chunks(out, npoint_chunks, [&](size_t c, std::ostream& buf) {
+            size_t end = std::min(npoints, (c+1) * points_per_chunk);
+            for (size_t i = c * points_per_chunk; i < end; ++i) {
+                if (i > c * points_per_chunk) buf << " ";
+                auto& pt = points[i];
+                buf << pt.x() << " " << pt.y() << " " << pt.z();
+            }
+        }, " ");
+        out <<
+        "\"/>\n"
+        "    <Color color=\"";
+        for (size_t i=0; i<npools; ++i) {
+            curv::Trace_Scope trace("colour pool");
+            openvdb::tools::PolygonPool& pool = pools[i];
+            for (size_t j=0; j<pool.numTriangles(); ++j) {
+                put_colour(out, shape,
+                    points[ pool.triangle(j)[0] ],
+                    points[ pool.triangle(j)[2] ],
+                    points[ pool.triangle(j)[1] ]);
+            }
+            for (size_t j=0; j<pool.numQuads(); ++j) {
+                put_colour(out, shape,
+                    points[ pool.quad(j)[0] ],
+                    points[ pool.quad(j)[2] ],
+                    points[ pool.quad(j)[1] ]);
+                put_colour(out, shape,
+                    points[ pool.quad(j)[0] ],
+                    points[ pool.quad(j)[3] ],
+                    points[ pool.quad(j)[2] ]);
+            }
+        }
+        out <<
+        "\"/>\n"
+        "   </IndexedFaceSet>\n"
+        "  </Shape>\n"
+        " </Scene>\n"
+        "</X3D>\n";
+        break;
+      }
+    default:
+        curv::die("bad mesh format");
+    }
+    return st;
+}
+
+// Report the triangle and quad count of a mesh, on the console.
+void report_mesh(Mesh_Stats st, const char* filename)
+{
+    if (filename[0] != '\0')
+        std::cerr << filename << ": ";
+    if (st.ntri == 0 && st.nquad == 0) {
+        std::cerr << "WARNING: no mesh was created (no volumes were found).\n"
+          << "Maybe you should try a smaller voxel size.\n";
+    } else {
+        if (st.ntri > 0)
+            std::cerr << st.ntri << " triangles";
+        if (st.ntri > 0 && st.nquad > 0)
+            std::cerr << ", ";
+        if (st.nquad > 0)
+            std::cerr << st.nquad << " quads";
+        std::cerr << ".\n";
     }
-    return result;
 }
 
 void export_mesh(Mesh_Format format, curv::Value value,
@@ -124,20 +389,43 @@ void export_mesh(Mesh_Format format, curv::Value value,
     // surrounding the sphere boundary, both inside and outside. To provide a
     // margin for error, I'll say that we need to populate voxels 2 units away
     // from the surface.
+    // OpenVDB voxel coordinates are 32 bit, so the range is computed in
+    // floating point and checked before conversion. Voxel counts can
+    // exceed 2^31, and are 64 bit.
+    double coord_limit = double(std::numeric_limits<int32_t>::max() - 8);
+    double voxelrange_d[6] = {
+        floor(shape.bbox_.xmin/voxelsize) - 2,
+        floor(shape.bbox_.ymin/voxelsize) - 2,
+        floor(shape.bbox_.zmin/voxelsize) - 2,
+        ceil(shape.bbox_.xmax/voxelsize) + 2,
+        ceil(shape.bbox_.ymax/voxelsize) + 2,
+        ceil(shape.bbox_.zmax/voxelsize) + 2,
+    };
+    for (double c : voxelrange_d) {
+        if (!(std::abs(c) <= coord_limit)) {
+            throw curv::Exception(cx, curv::stringify(
+                "mesh export: vsize=",voxelsize," is too small for this shape:"
+                " voxel coordinates exceed the 32 bit range"));
+        }
+    }
     Vec3i voxelrange_min(
-        int(floor(shape.bbox_.xmin/voxelsize)) - 2,
-        int(floor(shape.bbox_.ymin/voxelsize)) - 2,
-        int(floor(shape.bbox_.zmin/voxelsize)) - 2);
+        int(voxelrange_d[0]), int(voxelrange_d[1]), int(voxelrange_d[2]));
     Vec3i voxelrange_max(
-        int(ceil(shape.bbox_.xmax/voxelsize)) + 2,
-        int(ceil(shape.bbox_.ymax/voxelsize)) + 2,
-        int(ceil(shape.bbox_.zmax/voxelsize)) + 2);
+        int(voxelrange_d[3]), int(voxelrange_d[4]), int(voxelrange_d[5]));
+    int64_t xvoxels = int64_t(voxelrange_max.x()) - voxelrange_min.x() + 1;
+    int64_t yvoxels = int64_t(voxelrange_max.y()) - voxelrange_min.y() + 1;
+    int64_t zvoxels = int64_t(voxelrange_max.z()) - voxelrange_min.z() + 1;
+    double nvoxels_d = double(xvoxels) * double(yvoxels) * double(zvoxels);
+    if (nvoxels_d >= double(std::numeric_limits<int64_t>::max())) {
+        throw curv::Exception(cx, curv::stringify(
+            "mesh export: vsize=",voxelsize," is too small for this shape:"
+            " more than 2^63 voxels"));
+    }
+    int64_t nvoxels = xvoxels * yvoxels * zvoxels;
 
     std::cerr
         << "vsize="<<voxelsize<<": "
-        << (voxelrange_max.x() - voxelrange_min.x() + 1) << "×"
-        << (voxelrange_max.y() - voxelrange_min.y() + 1) << "×"
-        << (voxelrange_max.z() - voxelrange_min.z() + 1)
+        << xvoxels << "×" << yvoxels << "×" << zvoxels
         << " voxels. Use '-O vsize=N' to change voxel size.\n";
     std::cerr.flush();
 
@@ -147,9 +435,14 @@ void export_mesh(Mesh_Format format, curv::Value value,
     std::chrono::time_point<std::chrono::steady_clock> start_time, end_time;
     start_time = std::chrono::steady_clock::now();
 
-    // 2.0 is the background (or default) distance value for this
-    // sparse array of voxels. Each voxel is a `float`.
-    openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(2.0);
+    // The grid is a narrow band level set: only voxels within `band` of the
+    // surface are active and store a distance. Other voxels are inactive,
+    // and store +/- the background value to record which side of the surface
+    // they are on. Storage is proportional to the surface area, not the
+    // volume. The band is OpenVDB's standard half width of 3 voxels. Each
+    // voxel is a `float`.
+    const double band = openvdb::LEVEL_SET_HALF_WIDTH * voxelsize;
+    openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(band);
 
     // Attach a scaling transform that sets the voxel size in world space.
     grid->setTransform(
@@ -160,27 +453,90 @@ void export_mesh(Mesh_Format format, curv::Value value,
 
     // Populate the grid.
     // I assume each distance value is in the centre of a voxel.
+    // Voxels are visited in blocks the size of a leaf node (8×8×8). If the
+    // distance at the centre of a block shows that the whole block is outside
+    // the narrow band, then its voxels aren't sampled, and no leaf node is
+    // allocated: a block inside the shape becomes an inactive tile storing
+    // -band, and a block outside is left as background. Like the band scan
+    // in export_points, this is safe for distance fields that are only a
+    // bound, since they never overestimate the distance.
+    const int B = openvdb::FloatTree::LeafNodeType::DIM;
+    const double block_radius = 0.5 * (B-1) * voxelsize * std::sqrt(3.0);
     auto accessor = grid->getAccessor();
-    for (int x = voxelrange_min.x(); x <= voxelrange_max.x(); ++x) {
-        for (int y = voxelrange_min.y(); y <= voxelrange_max.y(); ++y) {
-            for (int z = voxelrange_min.z(); z <= voxelrange_max.z(); ++z) {
-                accessor.setValue(openvdb::Coord{x,y,z},
-                    shape.dist(x*voxelsize, y*voxelsize, z*voxelsize, 0.0));
+    int64_t nsampled = 0;
+    for (int bx = voxelrange_min.x() & ~(B-1); bx <= voxelrange_max.x();
+         bx += B)
+    {
+        curv::Trace_Scope trace("sample slab");
+        for (int by = voxelrange_min.y() & ~(B-1); by <= voxelrange_max.y();
+             by += B)
+        {
+            for (int bz = voxelrange_min.z() & ~(B-1);
+                 bz <= voxelrange_max.z(); bz += B)
+            {
+                double dc = shape.dist(
+                    (bx + 0.5*(B-1)) * voxelsize,
+                    (by + 0.5*(B-1)) * voxelsize,
+                    (bz + 0.5*(B-1)) * voxelsize,
+                    0.0);
+                if (std::abs(dc) >= band + block_radius) {
+                    if (dc < 0.0) {
+                        accessor.addTile(1, openvdb::Coord{bx,by,bz},
+                            -band, false);
+                    }
+                    continue;
+                }
+                int x0 = std::max(bx, voxelrange_min.x());
+                int y0 = std::max(by, voxelrange_min.y());
+                int z0 = std::max(bz, voxelrange_min.z());
+                int x1 = std::min(bx + B-1, voxelrange_max.x());
+                int y1 = std::min(by + B-1, voxelrange_max.y());
+                int z1 = std::min(bz + B-1, voxelrange_max.z());
+                for (int x = x0; x <= x1; ++x) {
+                    for (int y = y0; y <= y1; ++y) {
+                        for (int z = z0; z <= z1; ++z) {
+                            double d = shape.dist(
+                                x*voxelsize, y*voxelsize, z*voxelsize, 0.0);
+                            if (std::abs(d) < band)
+                                accessor.setValue(openvdb::Coord{x,y,z}, d);
+                            else
+                                accessor.setValueOff(openvdb::Coord{x,y,z},
+                                    d < 0.0 ? -band : band);
+                        }
+                    }
+                }
+                nsampled +=
+                    int64_t(x1-x0+1) * int64_t(y1-y0+1) * int64_t(z1-z0+1);
             }
         }
     }
+    // Merge uniform inactive leaf nodes and tiles, once, at the end.
+    openvdb::tools::pruneLevelSet(grid->tree());
     end_time = std::chrono::steady_clock::now();
     std::chrono::duration<double> render_time = end_time - start_time;
-    int nvoxels =
-        (voxelrange_max.x() - voxelrange_min.x() + 1) *
-        (voxelrange_max.y() - voxelrange_min.y() + 1) *
-        (voxelrange_max.z() - voxelrange_min.z() + 1);
     std::cerr
-        << "Rendered " << nvoxels
+        << "Sampled " << nsampled << " of " << nvoxels
         << " voxels in " << render_time.count() << "s ("
-        << int(nvoxels/render_time.count()) << " voxels/s).\n";
+        << std::llround(nsampled/render_time.count()) << " voxels/s), "
+        << grid->activeVoxelCount() << " in the narrow band.\n";
     std::cerr.flush();
 
+    // Distance fields produced by `smooth`, `twist` and the like are only
+    // bounds, not exact distances. `-O redistance` keeps the sign of the
+    // sampled grid, and recomputes exact distances in a narrow band around
+    // the zero set (in parallel, using OpenVDB).
+    if (params.find("redistance") != params.end()) {
+        curv::Trace_Scope trace("redistance");
+        start_time = std::chrono::steady_clock::now();
+        grid = openvdb::tools::levelSetRebuild(*grid, 0.0);
+        end_time = std::chrono::steady_clock::now();
+        std::chrono::duration<double> redistance_time = end_time - start_time;
+        std::cerr
+            << "Redistanced " << grid->activeVoxelCount()
+            << " narrow band voxels in " << redistance_time.count() << "s.\n";
+        std::cerr.flush();
+    }
+
     // convert grid to a mesh
     double adaptivity = 0.0;
     auto adaptive_p = params.find("adaptive");
@@ -195,148 +551,81 @@ void export_mesh(Mesh_Format format, curv::Value value,
             }
         }
     }
-    openvdb::tools::VolumeToMesh mesher(0.0, adaptivity);
-    mesher(*grid);
-
-    // output a mesh file
-    int ntri = 0;
-    int nquad = 0;
-    switch (format) {
-    case stl_format:
-        out << "solid curv\n";
-        for (int i=0; i<mesher.polygonPoolListSize(); ++i) {
-            openvdb::tools::PolygonPool& pool = mesher.polygonPoolList()[i];
-            for (int j=0; j<pool.numTriangles(); ++j) {
-                // swap ordering of nodes to get outside-normals
-                put_triangle(out,
-                    mesher.pointList()[ pool.triangle(j)[0] ],
-                    mesher.pointList()[ pool.triangle(j)[2] ],
-                    mesher.pointList()[ pool.triangle(j)[1] ]);
-                ++ntri;
-            }
-            for (int j=0; j<pool.numQuads(); ++j) {
-                // swap ordering of nodes to get outside-normals
-                put_triangle(out,
-                    mesher.pointList()[ pool.quad(j)[0] ],
-                    mesher.pointList()[ pool.quad(j)[2] ],
-                    mesher.pointList()[ pool.quad(j)[1] ]);
-                put_triangle(out,
-                    mesher.pointList()[ pool.quad(j)[0] ],
-                    mesher.pointList()[ pool.quad(j)[3] ],
-                    mesher.pointList()[ pool.quad(j)[2] ]);
-                ntri += 2;
-            }
-        }
-        out << "endsolid curv\n";
-        break;
-    case obj_format:
-        for (int i = 0; i < mesher.pointListSize(); ++i) {
-            auto& pt = mesher.pointList()[i];
-            out << "v " << pt.x() << " " << pt.y() << " " << pt.z() << "\n";
+    // Level of detail grids are resampled from the finest grid. Resampling
+    // and meshing are done in parallel, one thread per level of detail.
+    // They only touch OpenVDB data, not the evaluator, which isn't thread
+    // safe. Writing is sequential, since X3D output calls the colour function.
+    std::vector<Level_Of_Detail> lods;
+    lods.push_back({1, grid, nullptr});
+    auto lod_p = params.find("lod");
+    if (lod_p != params.end()) {
+        for (int factor : parse_lod_factors(lod_p, cx)) {
+            lods.push_back({factor, nullptr, nullptr});
         }
-        for (int i=0; i<mesher.polygonPoolListSize(); ++i) {
-            openvdb::tools::PolygonPool& pool = mesher.polygonPoolList()[i];
-            for (int j=0; j<pool.numTriangles(); ++j) {
-                // swap ordering of nodes to get outside-normals
-                auto& tri = pool.triangle(j);
-                out << "f " << tri[0]+1 << " "
-                            << tri[2]+1 << " "
-                            << tri[1]+1 << "\n";
-                ++ntri;
-            }
-            for (int j=0; j<pool.numQuads(); ++j) {
-                // swap ordering of nodes to get outside-normals
-                auto& q = pool.quad(j);
-                out << "f " << q[0]+1 << " "
-                            << q[3]+1 << " "
-                            << q[2]+1 << " "
-                            << q[1]+1 << "\n";
-                ++nquad;
-            }
-        }
-        break;
-    case x3d_format:
-      {
-        out <<
-        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
-        "<!DOCTYPE X3D PUBLIC \"ISO//Web3D//DTD X3D 3.1//EN\" \"http://www.web3d.org/specifications/x3d-3.1.dtd\">\n"
-        "<X3D profile=\"Interchange\" version=\"3.1\" xsd:noNamespaceSchemaLocation=\"http://www.web3d.org/specifications/x3d-3.1.xsd\" xmlns:xsd=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
-        " <head>\n"
-        "  <meta content=\"Curv, https://github.com/doug-moen/curv\" name=\"generator\"/>\n"
-        " </head>\n"
-        " <Scene>\n"
-        "  <Shape>\n"
-        "   <IndexedFaceSet colorPerVertex=\"false\" coordIndex=\"";
-        bool first = true;
-        for (int i=0; i<mesher.polygonPoolListSize(); ++i) {
-            openvdb::tools::PolygonPool& pool = mesher.polygonPoolList()[i];
-            for (int j=0; j<pool.numTriangles(); ++j) {
-                if (!first) out << " "; first = false;
-                auto& tri = pool.triangle(j);
-                out << tri[0] << " " << tri[2] << " " << tri[1] << " -1";
-                ++ntri;
-            }
-            for (int j=0; j<pool.numQuads(); ++j) {
-                if (!first) out << " "; first = false;
-                auto& q = pool.quad(j);
-                out << q[0] << " " << q[2] << " " << q[1] << " -1 "
-                    << q[0] << " " << q[3] << " " << q[2] << " -1";
-                ntri += 2;
-            }
-        }
-        out <<
-        "\">\n"
-        "    <Coordinate point=\"";
-        first = true;
-        for (int i = 0; i < mesher.pointListSize(); ++i) {
-            if (!first) out << " "; first = false;
-            auto& pt = mesher.pointList()[i];
-            out << pt.x() << " " << pt.y() << " " << pt.z();
-        }
-        out <<
-        "\"/>\n"
-        "    <Color color=\"";
-        for (int i=0; i<mesher.polygonPoolListSize(); ++i) {
-            openvdb::tools::PolygonPool& pool = mesher.polygonPoolList()[i];
-            for (int j=0; j<pool.numTriangles(); ++j) {
-                put_colour(out, shape,
-                    mesher.pointList()[ pool.triangle(j)[0] ],
-                    mesher.pointList()[ pool.triangle(j)[2] ],
-                    mesher.pointList()[ pool.triangle(j)[1] ]);
-            }
-            for (int j=0; j<pool.numQuads(); ++j) {
-                put_colour(out, shape,
-                    mesher.pointList()[ pool.quad(j)[0] ],
-                    mesher.pointList()[ pool.quad(j)[2] ],
-                    mesher.pointList()[ pool.quad(j)[1] ]);
-                put_colour(out, shape,
-                    mesher.pointList()[ pool.quad(j)[0] ],
-                    mesher.pointList()[ pool.quad(j)[3] ],
-                    mesher.pointList()[ pool.quad(j)[2] ]);
-            }
+    }
+    {
+        curv::Trace_Scope trace("mesh");
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(lods.size());
+        for (size_t i = 0; i < lods.size(); ++i) {
+            threads.emplace_back([&, i]() {
+                try {
+                    auto& lod = lods[i];
+                    if (lod.grid == nullptr) {
+                        curv::Trace_Scope trace("resample");
+                        lod.grid = openvdb::FloatGrid::create(
+                            band * lod.factor);
+                        lod.grid->setTransform(
+                            openvdb::math::Transform::createLinearTransform(
+                                voxelsize * lod.factor));
+                        lod.grid->setGridClass(openvdb::GRID_LEVEL_SET);
+                        openvdb::tools::resampleToMatch<
+                            openvdb::tools::BoxSampler>(*grid, *lod.grid);
+                    }
+                    lod.mesher.reset(
+                        new openvdb::tools::VolumeToMesh(0.0, adaptivity));
+                    (*lod.mesher)(*lod.grid);
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
         }
-        out <<
-        "\"/>\n"
-        "   </IndexedFaceSet>\n"
-        "  </Shape>\n"
-        " </Scene>\n"
-        "</X3D>\n";
-        break;
-      }
-    default:
-        curv::die("bad mesh format");
+        for (auto& t : threads)
+            t.join();
+        for (auto& e : errors)
+            if (e) std::rethrow_exception(e);
     }
 
-    if (ntri == 0 && nquad == 0) {
-        std::cerr << "WARNING: no mesh was created (no volumes were found).\n"
-          << "Maybe you should try a smaller voxel size.\n";
-    } else {
-        if (ntri > 0)
-            std::cerr << ntri << " triangles";
-        if (ntri > 0 && nquad > 0)
-            std::cerr << ", ";
-        if (nquad > 0)
-            std::cerr << nquad << " quads";
-        std::cerr << ".\n";
+    curv::Trace_Scope write_trace("write");
+    report_mesh(write_mesh(format, *lods[0].mesher, shape, out), "");
+    std::string prefix = "curv";
+    auto prefix_p = params.find("lodprefix");
+    if (prefix_p != params.end())
+        prefix = prefix_p->second;
+    // The level of detail files are compressed like standard output.
+    auto compress_p = params.find("compress");
+    for (size_t i = 1; i < lods.size(); ++i) {
+        std::string filename = curv::stringify(prefix, "_lod", lods[i].factor,
+            format_extension(format),
+            compress_p != params.end()
+                ? compression_suffix(compress_p->second) : "")->c_str();
+        std::ofstream lod_file(filename, std::ios::binary);
+        if (!lod_file) {
+            throw curv::Exception(cx, curv::stringify(
+                "mesh export: can't open ", filename.c_str()));
+        }
+        boost::iostreams::filtering_ostream lod_out;
+        if (compress_p != params.end())
+            push_compressor(lod_out, compress_p->second);
+        lod_out.push(lod_file);
+        report_mesh(write_mesh(format, *lods[i].mesher, shape, lod_out),
+            filename.c_str());
+        // Flush the compressor and write the trailer.
+        lod_out.reset();
+        lod_file.close();
+        if (!lod_file) {
+            throw curv::Exception(cx, curv::stringify(
+                "mesh export: error writing ", filename.c_str()));
+        }
     }
 }
@@ -0,0 +1,293 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+// Export a point cloud sampled from the surface of a 3D shape,
+// with normals and optional colour.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "export.h"
+#include <curv/shape.h>
+#include <curv/exception.h>
+#include <curv/trace.h>
+
+using curv::Vec3;
+
+namespace {
+
+inline Vec3 operator+(Vec3 a, Vec3 b) { return {a.x+b.x, a.y+b.y, a.z+b.z}; }
+inline Vec3 operator-(Vec3 a, Vec3 b) { return {a.x-b.x, a.y-b.y, a.z-b.z}; }
+inline Vec3 operator*(double s, Vec3 a) { return {s*a.x, s*a.y, s*a.z}; }
+inline double dot(Vec3 a, Vec3 b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+
+struct Surface_Point
+{
+    Vec3 pos;
+    Vec3 normal;
+};
+
+// Gradient of the distance field, by central differences.
+Vec3 gradient(curv::Shape_Recognizer& shape, Vec3 p, double eps)
+{
+    return {
+        shape.dist(p.x+eps, p.y, p.z, 0.0) - shape.dist(p.x-eps, p.y, p.z, 0.0),
+        shape.dist(p.x, p.y+eps, p.z, 0.0) - shape.dist(p.x, p.y-eps, p.z, 0.0),
+        shape.dist(p.x, p.y, p.z+eps, 0.0) - shape.dist(p.x, p.y, p.z-eps, 0.0),
+    };
+}
+
+// Move `p` onto the zero set along the gradient, using Newton iteration.
+// Fails if the iteration doesn't converge, or if the gradient vanishes
+// (eg, at a crease or on a medial surface).
+bool project(curv::Shape_Recognizer& shape, Vec3& p, Vec3& normal,
+    double eps, double tolerance)
+{
+    for (int i = 0; i < 8; ++i) {
+        double d = shape.dist(p.x, p.y, p.z, 0.0);
+        Vec3 g = (0.5/eps) * gradient(shape, p, eps);
+        double g2 = dot(g, g);
+        if (!(g2 > 1e-12))
+            return false;
+        if (std::abs(d) <= tolerance) {
+            normal = (1.0/std::sqrt(g2)) * g;
+            return true;
+        }
+        p = p - (d/g2) * g;
+    }
+    return false;
+}
+
+// Blue noise: a hash grid of accepted points, with cell size equal to the
+// minimum spacing, so that conflicting points lie in the 27 neighbouring
+// cells.
+struct Spacing_Grid
+{
+    double spacing_;
+    std::unordered_map<uint64_t, std::vector<Vec3>> cells_;
+
+    Spacing_Grid(double spacing) : spacing_(spacing) {}
+
+    static uint64_t key(int64_t i, int64_t j, int64_t k)
+    {
+        return (uint64_t(i) & 0x1FFFFF)
+            | ((uint64_t(j) & 0x1FFFFF) << 21)
+            | ((uint64_t(k) & 0x1FFFFF) << 42);
+    }
+    int64_t coord(double x) const { return int64_t(std::floor(x/spacing_)); }
+
+    // If p is at least `spacing` from every point in the grid, add it.
+    bool insert(Vec3 p)
+    {
+        int64_t i = coord(p.x), j = coord(p.y), k = coord(p.z);
+        double s2 = spacing_*spacing_;
+        for (int64_t di = -1; di <= 1; ++di)
+        for (int64_t dj = -1; dj <= 1; ++dj)
+        for (int64_t dk = -1; dk <= 1; ++dk) {
+            auto c = cells_.find(key(i+di, j+dj, k+dk));
+            if (c == cells_.end()) continue;
+            for (auto q : c->second) {
+                Vec3 d = p - q;
+                if (dot(d, d) < s2)
+                    return false;
+            }
+        }
+        cells_[key(i,j,k)].push_back(p);
+        return true;
+    }
+};
+
+// Write a float in little endian byte order, as declared in the PLY header,
+// whatever the byte order of the host.
+void put_float(std::ostream& out, float f)
+{
+    std::uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    char bytes[4] = {
+        char(u & 0xFF), char((u >> 8) & 0xFF),
+        char((u >> 16) & 0xFF), char((u >> 24) & 0xFF)
+    };
+    out.write(bytes, sizeof(bytes));
+}
+
+} // namespace
+
+void export_points(curv::Value value,
+    curv::System& sys, const curv::Context& cx, const Export_Params& params,
+    std::ostream& out)
+{
+    curv::Shape_Recognizer shape(cx, sys);
+    if (!shape.recognize(value) || !shape.is_3d_)
+        throw curv::Exception(cx, "points export: not a 3D shape");
+
+    double xsize = shape.bbox_.xmax - shape.bbox_.xmin;
+    double ysize = shape.bbox_.ymax - shape.bbox_.ymin;
+    double zsize = shape.bbox_.zmax - shape.bbox_.zmin;
+    double volume = xsize * ysize * zsize;
+    if (!std::isfinite(volume))
+        throw curv::Exception(cx, "points export: shape is infinite");
+
+    long count = 100'000;
+    auto count_p = params.find("count");
+    if (count_p != params.end()) {
+        double n = param_to_double(count_p);
+        if (n < 1 || n != std::floor(n)) {
+            throw curv::Exception(cx, curv::stringify(
+                "points export: invalid parameter count=",count_p->second));
+        }
+        count = long(n);
+    }
+    double spacing = 0.0;
+    auto spacing_p = params.find("spacing");
+    if (spacing_p != params.end()) {
+        spacing = param_to_double(spacing_p);
+        if (spacing < 0.0) {
+            throw curv::Exception(cx, curv::stringify(
+                "points export: invalid parameter spacing=",spacing_p->second));
+        }
+    }
+    bool raw = false;
+    auto format_p = params.find("format");
+    if (format_p != params.end()) {
+        if (format_p->second == "raw")
+            raw = true;
+        else if (format_p->second != "ply") {
+            throw curv::Exception(cx, curv::stringify(
+                "points export: format must be 'ply' or 'raw', not '",
+                format_p->second,"'"));
+        }
+    }
+    bool colour = false;
+    auto colour_p = params.find("colour");
+    if (colour_p != params.end())
+        colour = param_to_bool(colour_p);
+
+    // Find the cells of a coarse grid that intersect the narrow band around
+    // the surface. The cell size is chosen like the default mesh export
+    // voxel size. A cell is in the band if the distance at its centre is
+    // less than the cell's circumradius, plus a margin for distance fields
+    // that are only a bound.
+    double cellsize = std::cbrt(volume / 100'000);
+    if (!(cellsize > 0.0))
+        throw curv::Exception(cx, "points export: shape has zero volume");
+    long nx = long(std::ceil(xsize/cellsize)) + 2;
+    long ny = long(std::ceil(ysize/cellsize)) + 2;
+    long nz = long(std::ceil(zsize/cellsize)) + 2;
+    Vec3 origin{
+        shape.bbox_.xmin - cellsize,
+        shape.bbox_.ymin - cellsize,
+        shape.bbox_.zmin - cellsize};
+    double band = cellsize * std::sqrt(3.0);
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<Vec3> band_cells;
+    for (long i = 0; i < nx; ++i) {
+        curv::Trace_Scope trace("band scan slab");
+        for (long j = 0; j < ny; ++j) {
+            for (long k = 0; k < nz; ++k) {
+                Vec3 c{origin.x + (i+0.5)*cellsize,
+                       origin.y + (j+0.5)*cellsize,
+                       origin.z + (k+0.5)*cellsize};
+                if (std::abs(shape.dist(c.x, c.y, c.z, 0.0)) <= band)
+                    band_cells.push_back({c.x - 0.5*cellsize,
+                                          c.y - 0.5*cellsize,
+                                          c.z - 0.5*cellsize});
+            }
+        }
+    }
+    if (band_cells.empty())
+        throw curv::Exception(cx, "points export: shape has no surface");
+
+    // Seed candidate points uniformly in randomly chosen band cells,
+    // and project them onto the surface. The seed is fixed, so that
+    // the output is reproducible.
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<size_t> pick_cell(0, band_cells.size()-1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double eps = cellsize * 1e-3;
+    double tolerance = cellsize * 1e-5;
+    Spacing_Grid grid(spacing);
+    std::vector<Surface_Point> points;
+    // The count is user supplied, so don't trust it for a large reservation.
+    points.reserve(std::min(count, 1'000'000L));
+    long attempts = 0;
+    long max_attempts = 20 * count;
+    {
+        curv::Trace_Scope trace("project points");
+        while (long(points.size()) < count && attempts < max_attempts) {
+            ++attempts;
+            Vec3 cell = band_cells[pick_cell(rng)];
+            Vec3 p{cell.x + unit(rng)*cellsize,
+                   cell.y + unit(rng)*cellsize,
+                   cell.z + unit(rng)*cellsize};
+            Vec3 normal;
+            if (!project(shape, p, normal, eps, tolerance))
+                continue;
+            if (spacing > 0.0 && !grid.insert(p))
+                continue;
+            points.push_back({p, normal});
+        }
+    }
+    auto end_time = std::chrono::steady_clock::now();
+    std::chrono::duration<double> sample_time = end_time - start_time;
+    std::cerr << "Sampled " << points.size() << " points from "
+        << band_cells.size() << " surface cells in "
+        << sample_time.count() << "s.";
+    if (long(points.size()) < count)
+        std::cerr << " Fewer than count=" << count
+                  << " points: use a smaller spacing.";
+    std::cerr << "\n";
+    std::cerr.flush();
+
+    curv::Trace_Scope trace("write");
+
+    // Output. PLY colours are sRGB bytes; raw colours are linear floats,
+    // as returned by the shape's colour function.
+    if (!raw) {
+        out << "ply\n"
+            << "format binary_little_endian 1.0\n"
+            << "comment generated by Curv\n"
+            << "element vertex " << points.size() << "\n"
+            << "property float x\n"
+            << "property float y\n"
+            << "property float z\n"
+            << "property float nx\n"
+            << "property float ny\n"
+            << "property float nz\n";
+        if (colour) {
+            out << "property uchar red\n"
+                << "property uchar green\n"
+                << "property uchar blue\n";
+        }
+        out << "end_header\n";
+    }
+    for (auto& pt : points) {
+        put_float(out, pt.pos.x);
+        put_float(out, pt.pos.y);
+        put_float(out, pt.pos.z);
+        put_float(out, pt.normal.x);
+        put_float(out, pt.normal.y);
+        put_float(out, pt.normal.z);
+        if (colour) {
+            Vec3 c = shape.colour(pt.pos.x, pt.pos.y, pt.pos.z, 0.0);
+            if (raw) {
+                put_float(out, c.x);
+                put_float(out, c.y);
+                put_float(out, c.z);
+            } else {
+                for (double v : {c.x, c.y, c.z}) {
+                    v = std::pow(std::min(std::max(v, 0.0), 1.0), 1.0/2.2);
+                    out.put(char(uint8_t(std::lround(v * 255.0))));
+                }
+            }
+        }
+    }
+}
@@ -191,7 +191,16 @@ Brace_Segment_Phrase::analyse(Environ& env) const
 Shared<Meaning>
 String_Phrase_Base::analyse(Environ& env) const
 {
-    return analyse_string(env);
+    auto str = analyse_string(env);
+    for (auto seg : *str)
+        if (!isa<Literal_Segment>(seg))
+            return str;
+
+    // A string literal with no substitutions is folded into a Constant.
+    String_Builder sb;
+    for (auto seg : *str)
+        sb << *((Literal_Segment&)*seg).data_;
+    return make<Constant>(share(*this), sb.get_value());
 }
 Shared<String_Expr>
 String_Phrase_Base::analyse_string(Environ& env) const
@@ -211,13 +220,24 @@ Unary_Phrase::analyse(Environ& env) const
             share(*this),
             analyse_op(*arg_, env));
     case Token::k_plus:
-        return make<Positive_Expr>(
-            share(*this),
-            analyse_op(*arg_, env));
+      {
+        auto arg = analyse_op(*arg_, env);
+        auto k = cast<Constant>(arg);
+        if (k && k->value_.is_num())
+            return make<Constant>(share(*this), k->value_);
+        return make<Positive_Expr>(share(*this), arg);
+      }
     case Token::k_minus:
-        return make<Negative_Expr>(
-            share(*this),
-            analyse_op(*arg_, env));
+      {
+        // Fold negative numerals like -1 into constants,
+        // so that numeric list literals can be folded (see fold_list).
+        auto arg = analyse_op(*arg_, env);
+        auto k = cast<Constant>(arg);
+        if (k && k->value_.is_num())
+            return make<Constant>(share(*this),
+                Value{-k->value_.get_num_unsafe()});
+        return make<Negative_Expr>(share(*this), arg);
+      }
     case Token::k_ellipsis:
         return make<Spread_Op>(
             share(*this),
@@ -650,17 +670,33 @@ Comma_Phrase::analyse(Environ& env) const
     throw Exception(At_Token(args_[0].separator_, *this, env), "syntax error");
 }
 
+// A list literal whose elements are all constants is folded into a single
+// Constant containing a prebuilt List. Evaluating it is a refcount increment,
+// instead of evaluating each element into a List_Builder, and the per-element
+// Operation nodes are discarded.
+Shared<Meaning>
+fold_list(Shared<List_Expr> list)
+{
+    for (auto e : *list)
+        if (!isa<Constant>(e))
+            return list;
+    Shared<List> val = List::make(list->size());
+    for (size_t i = 0; i < list->size(); ++i)
+        (*val)[i] = ((Constant&)*(*list)[i]).value_;
+    return make<Constant>(list->source_, Value{val});
+}
+
 Shared<Meaning>
 Paren_Phrase::analyse(Environ& env) const
 {
     if (cast<const Empty_Phrase>(body_))
-        return List_Expr::make(0, share(*this));
+        return fold_list(List_Expr::make(0, share(*this)));
     if (auto commas = dynamic_cast<const Comma_Phrase*>(&*body_)) {
         auto& items = commas->args_;
         Shared<List_Expr> list = List_Expr::make(items.size(), share(*this));
         for (size_t i = 0; i < items.size(); ++i)
             (*list)[i] = analyse_op(*items[i].expr_, env);
-        return list;
+        return fold_list(list);
     } else {
         // One of the few places we directly call Phrase::analyse().
         // The result can be an operation or a metafunction.
@@ -677,17 +713,17 @@ Shared<Meaning>
 Bracket_Phrase::analyse(Environ& env) const
 {
     if (cast<const Empty_Phrase>(body_))
-        return List_Expr::make(0, share(*this));
+        return fold_list(List_Expr::make(0, share(*this)));
     if (auto commas = dynamic_cast<const Comma_Phrase*>(&*body_)) {
         auto& items = commas->args_;
         Shared<List_Expr> list = List_Expr::make(items.size(), share(*this));
         for (size_t i = 0; i < items.size(); ++i)
             (*list)[i] = analyse_op(*items[i].expr_, env);
-        return list;
+        return fold_list(list);
     } else {
         Shared<List_Expr> list = List_Expr::make(1, share(*this));
         (*list)[0] = analyse_op(*body_, env);
-        return list;
+        return fold_list(list);
     }
 }
 
@@ -727,6 +763,35 @@ Program_Phrase::as_definition(Environ& env)
     return body_->as_definition(env);
 }
 
+// A record literal whose fields all have constant names and values is
+// folded into a Constant, like a list literal (see fold_list).
+Shared<Meaning>
+fold_record(Shared<Record_Expr> expr)
+{
+    auto record = make<Record>();
+    for (auto op : expr->fields_) {
+        auto assoc = cast<const Assoc>(op);
+        if (assoc == nullptr)
+            return expr;
+        auto k = cast<const Constant>(assoc->definiens_);
+        if (k == nullptr)
+            return expr;
+        if (assoc->name_.id_)
+            record->fields_[assoc->name_.id_->atom_] = k->value_;
+        else {
+            String_Builder sb;
+            for (auto seg : *assoc->name_.string_) {
+                auto lit = cast<const Literal_Segment>(seg);
+                if (lit == nullptr)
+                    return expr;
+                sb << *lit->data_;
+            }
+            record->fields_[sb.get_string()] = k->value_;
+        }
+    }
+    return make<Constant>(expr->source_, Value{record});
+}
+
 Shared<Meaning>
 Brace_Phrase::analyse(Environ& env) const
 {
@@ -736,7 +801,7 @@ Brace_Phrase::analyse(Environ& env) const
         each_item(*body_, [&](Phrase& item)->void {
             record->fields_.push_back(analyse_op(item, env));
         });
-        return record;
+        return fold_record(record);
     }
     return analyse_module(*adef, env);
 }
@@ -36,33 +36,33 @@ struct Binary_Numeric_Array_Op
     }
 
     static Value
-    op(Value x, Value y, const Context& cx)
+    op(const Value& x, const Value& y, const Context& cx)
     {
         double r = Scalar_Op::f(x.get_num_or_nan(), y.get_num_or_nan());
         if (r == r)
             return {r};
-        if (auto xlist = x.dycast<List>()) {
-            if (auto ylist = y.dycast<List>())
-                return {element_wise_op(xlist, ylist, cx)};
-            return {broadcast_left(xlist, y, cx)};
+        if (auto xlist = x.dycast_ptr<const List>()) {
+            if (auto ylist = y.dycast_ptr<const List>())
+                return {element_wise_op(*xlist, *ylist, cx)};
+            return {broadcast_left(*xlist, y, cx)};
         }
-        if (auto ylist = y.dycast<List>())
-            return {broadcast_right(x, ylist, cx)};
+        if (auto ylist = y.dycast_ptr<const List>())
+            return {broadcast_right(x, *ylist, cx)};
         throw Exception(cx,
             stringify(Scalar_Op::callstr(x,y),": domain error"));
     }
 
     static Shared<List>
-    broadcast_left(Shared<List> xlist, Value y, const Context& cx)
+    broadcast_left(const List& xlist, const Value& y, const Context& cx)
     {
-        Shared<List> result = List::make(xlist->size());
-        for (unsigned i = 0; i < xlist->size(); ++i) {
-            Value ex = (*xlist)[i];
+        Shared<List> result = List::make(xlist.size());
+        for (unsigned i = 0; i < xlist.size(); ++i) {
+            Value ex = xlist[i];
             double r = Scalar_Op::f(ex.get_num_or_nan(),y.get_num_or_nan());
             if (r == r)
                 (*result)[i] = {r};
-            else if (auto exlist = ex.dycast<List>())
-                (*result)[i] = {broadcast_left(exlist, y, cx)};
+            else if (auto exlist = ex.dycast_ptr<const List>())
+                (*result)[i] = {broadcast_left(*exlist, y, cx)};
             else
                 throw Exception(cx,
                     stringify(Scalar_Op::callstr(ex,y),": domain error"));
@@ -71,16 +71,16 @@ struct Binary_Numeric_Array_Op
     }
 
     static Shared<List>
-    broadcast_right(Value x, Shared<List> ylist, const Context& cx)
+    broadcast_right(const Value& x, const List& ylist, const Context& cx)
     {
-        Shared<List> result = List::make(ylist->size());
-        for (unsigned i = 0; i < ylist->size(); ++i) {
-            Value ey = (*ylist)[i];
+        Shared<List> result = List::make(ylist.size());
+        for (unsigned i = 0; i < ylist.size(); ++i) {
+            Value ey = ylist[i];
             double r = Scalar_Op::f(x.get_num_or_nan(), ey.get_num_or_nan());
             if (r == r)
                 (*result)[i] = {r};
-            else if (auto eylist = ey.dycast<List>())
-                (*result)[i] = {broadcast_right(x, eylist, cx)};
+            else if (auto eylist = ey.dycast_ptr<const List>())
+                (*result)[i] = {broadcast_right(x, *eylist, cx)};
             else
                 throw Exception(cx,
                     stringify(Scalar_Op::callstr(x,ey),": domain error"));
@@ -89,16 +89,16 @@ struct Binary_Numeric_Array_Op
     }
 
     static Shared<List>
-    element_wise_op(Shared<List> xs, Shared<List> ys, const Context& cx)
+    element_wise_op(const List& xs, const List& ys, const Context& cx)
     {
-        if (xs->size() != ys->size())
+        if (xs.size() != ys.size())
             throw Exception(cx, stringify(
                 Scalar_Op::name(),
                 ": mismatched list sizes (",
-                xs->size(),",",ys->size(),") in array operation"));
-        Shared<List> result = List::make(xs->size());
-        for (unsigned i = 0; i < xs->size(); ++i)
-            (*result)[i] = op((*xs)[i], (*ys)[i], cx);
+                xs.size(),",",ys.size(),") in array operation"));
+        Shared<List> result = List::make(xs.size());
+        for (unsigned i = 0; i < xs.size(); ++i)
+            (*result)[i] = op(xs[i], ys[i], cx);
         return result;
     }
 };
@@ -109,23 +109,23 @@ struct Unary_Numeric_Array_Op
     // TODO: optimize: move semantics. unique object reuse.
 
     static Value
-    op(Value x, const Context& cx)
+    op(const Value& x, const Context& cx)
     {
         double r = Scalar_Op::f(x.get_num_or_nan());
         if (r == r)
             return {r};
-        if (auto xlist = x.dycast<List>())
-            return {element_wise_op(xlist, cx)};
+        if (auto xlist = x.dycast_ptr<const List>())
+            return {element_wise_op(*xlist, cx)};
         throw Exception(cx,
             stringify(Scalar_Op::callstr(x),": domain error"));
     }
 
     static Shared<List>
-    element_wise_op(Shared<List> xs, const Context& cx)
+    element_wise_op(const List& xs, const Context& cx)
     {
-        Shared<List> result = List::make(xs->size());
-        for (unsigned i = 0; i < xs->size(); ++i)
-            (*result)[i] = op((*xs)[i], cx);
+        Shared<List> result = List::make(xs.size());
+        for (unsigned i = 0; i < xs.size(); ++i)
+            (*result)[i] = op(xs[i], cx);
         return result;
     }
 };
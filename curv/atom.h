@@ -6,6 +6,7 @@
 #define CURV_ATOM_H
 
 #include <map>
+#include <unordered_map>
 #include <curv/string.h>
 
 namespace curv {
@@ -17,7 +18,6 @@ namespace curv {
 /// The name comes from Lisp.
 ///
 /// Possible changes in future revisions:
-/// * Add a hash code, so that we can use hash trees for Atom_Map.
 /// * Use a global atom table stored in the curv::Session object to ensure
 ///   that atoms are unique, so we can use pointer equality as atom equality.
 ///   This will also eliminate refcount manipulation, at a cost: the atom
@@ -72,6 +72,19 @@ public:
     inline const char* c_str() const { return (*this)->c_str(); }
     inline char operator[](size_t i) const { return (**this)[i]; }
 
+    /// FNV-1a hash of the characters. Not cached: the atoms used as symbol
+    /// table keys are short, so hashing is cheaper than the string compares
+    /// done by a tree lookup.
+    size_t hash() const noexcept
+    {
+        size_t h = size_t(14695981039346656037ULL);
+        for (const char* p = data(), *e = p + size(); p < e; ++p) {
+            h ^= (unsigned char)*p;
+            h *= size_t(1099511628211ULL);
+        }
+        return h;
+    }
+
     friend void swap(Atom& a1, Atom& a2) noexcept
     {
         a1.swap(a2);
@@ -85,9 +98,30 @@ public:
 
     Value to_value() const
     {
-        // Currently, we copy the string data, because an Atom is immutable,
+        // Most atoms are short enough to be stored inline in the Value.
+        // Otherwise, we copy the string data, because an Atom is immutable,
         // but a Value can only be constructed from a mutable String reference.
-        return {String::make(data(), size())};
+        return make_string_value(data(), size());
+    }
+};
+
+/// Atom ordering for Atom_Map. It also compares an Atom with a C string,
+/// in the same order, so that a map can be searched by a field name computed
+/// at run time without allocating an Atom.
+struct Atom_Less
+{
+    using is_transparent = void;
+    bool operator()(const Atom& a1, const Atom& a2) const noexcept
+    {
+        return a1 < a2;
+    }
+    bool operator()(const Atom& a1, const char* s2) const noexcept
+    {
+        return strcmp(a1.c_str(), s2) < 0;
+    }
+    bool operator()(const char* s1, const Atom& a2) const noexcept
+    {
+        return strcmp(s1, a2.c_str()) < 0;
     }
 };
 
@@ -95,9 +129,24 @@ public:
 /// It's supposed to be a persistent functional data structure with
 /// an efficient merge operation, and that's not implemented yet.
 template<typename T>
-struct Atom_Map : public std::map<Atom, T>
+struct Atom_Map : public std::map<Atom, T, Atom_Less>
+{
+    using std::map<Atom,T,Atom_Less>::map;
+};
+
+struct Atom_Hash
+{
+    size_t operator()(const Atom& a) const noexcept { return a.hash(); }
+};
+
+/// An Atom_Table is an unordered hash map from Atom to T.
+/// It's used for compile time symbol tables, which are only searched,
+/// never iterated in an order that is visible to Curv programs.
+/// Use Atom_Map when the iteration order matters (eg, record fields).
+template<typename T>
+struct Atom_Table : public std::unordered_map<Atom, T, Atom_Hash>
 {
-    using std::map<Atom,T>::map;
+    using std::unordered_map<Atom,T,Atom_Hash>::unordered_map;
 };
 
 } // namespace curv
@@ -0,0 +1,37 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#include <curv/budget.h>
+#include <curv/context.h>
+#include <curv/exception.h>
+
+namespace curv {
+
+thread_local Budget* thread_budget = nullptr;
+
+namespace {
+// Building an exception allocates, so the budget is suspended meanwhile.
+struct Suspend_Budget
+{
+    Budget* saved_ = thread_budget;
+    Suspend_Budget() { thread_budget = nullptr; }
+    ~Suspend_Budget() { thread_budget = saved_; }
+};
+}
+
+void throw_alloc_budget_exceeded(Budget& b)
+{
+    Suspend_Budget suspend;
+    throw Exception(Context{}, stringify(
+        "allocation budget of ",b.max_alloc_bytes_," bytes exceeded"));
+}
+
+void throw_step_budget_exceeded(Budget& b, const Context& cx)
+{
+    Suspend_Budget suspend;
+    throw Exception(cx, stringify(
+        "step budget of ",b.max_steps_," evaluation steps exceeded"));
+}
+
+} // namespace curv
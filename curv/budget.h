@@ -0,0 +1,85 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef CURV_BUDGET_H
+#define CURV_BUDGET_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace curv {
+
+struct Context;
+
+/// Resource limits for evaluating untrusted code.
+///
+/// Steps are counted by function calls, loop iterations and range elements.
+/// Allocation is the total number of bytes allocated for Curv heap objects
+/// (not the live heap size). A limit of 0 means unlimited.
+/// When a limit is exceeded, a curv::Exception is thrown; a budget that
+/// is exhausted stays exhausted, so evaluation can't continue past a
+/// `catch` that ignores the error.
+///
+/// A budget applies to the current thread, while a Budget_Scope is active.
+struct Budget
+{
+    std::uint64_t max_steps_ = 0;
+    std::uint64_t max_alloc_bytes_ = 0;
+    std::uint64_t steps_ = 0;
+    std::uint64_t alloc_bytes_ = 0;
+
+    Budget() {}
+    Budget(std::uint64_t max_steps, std::uint64_t max_alloc_bytes)
+    :
+        max_steps_(max_steps),
+        max_alloc_bytes_(max_alloc_bytes)
+    {}
+
+    /// Count `n` steps. Returns true if the step limit is exceeded.
+    /// The caller throws an Exception, since it knows the source location.
+    bool step(std::uint64_t n = 1)
+    {
+        steps_ += n;
+        return max_steps_ != 0 && steps_ > max_steps_;
+    }
+};
+
+/// The budget for the current thread, or nullptr if there is no limit.
+extern thread_local Budget* thread_budget;
+
+/// Install a budget on the current thread for the lifetime of this object.
+struct Budget_Scope
+{
+    Budget* saved_;
+    Budget_Scope(Budget& b) : saved_(thread_budget) { thread_budget = &b; }
+    ~Budget_Scope() { thread_budget = saved_; }
+    Budget_Scope(const Budget_Scope&) = delete;
+    Budget_Scope& operator=(const Budget_Scope&) = delete;
+};
+
+[[noreturn]] void throw_alloc_budget_exceeded(Budget&);
+[[noreturn]] void throw_step_budget_exceeded(Budget&, const Context&);
+
+/// Charge `n` evaluation steps to the current thread's budget.
+/// The Context is only constructed if a budget is active:
+///     if (Budget* b = thread_budget)
+///         budget_step(*b, 1, At_Phrase(*source_, &f));
+inline void budget_step(Budget& b, std::uint64_t n, const Context& cx)
+{
+    if (b.step(n))
+        throw_step_budget_exceeded(b, cx);
+}
+
+/// Charge an allocation to the current thread's budget.
+inline void budget_alloc(std::size_t bytes)
+{
+    if (Budget* b = thread_budget) {
+        b->alloc_bytes_ += bytes;
+        if (b->max_alloc_bytes_ != 0 && b->alloc_bytes_ > b->max_alloc_bytes_)
+            throw_alloc_budget_exceeded(*b);
+    }
+}
+
+} // namespace curv
+#endif // header guard
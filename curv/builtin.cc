@@ -2,10 +2,15 @@
 // Licensed under the Apache License, version 2.0
 // See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <climits>
 #include <cmath>
 #include <cstdlib>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <boost/math/constants/constants.hpp>
 #include <boost/filesystem.hpp>
@@ -22,6 +27,7 @@
 #include <curv/array_op.h>
 #include <curv/analyser.h>
 #include <curv/math.h>
+#include <curv/stream.h>
 
 using namespace std;
 using namespace boost::math::double_constants;
@@ -63,7 +69,7 @@ struct Is_String_Function : public Polyadic_Function
     Is_String_Function() : Polyadic_Function(1) {}
     Value call(Frame& args) override
     {
-        return {args[0].dycast<String>() != nullptr};
+        return {bool(String_Ref(args[0]))};
     }
 };
 struct Is_List_Function : public Polyadic_Function
@@ -71,7 +77,15 @@ struct Is_List_Function : public Polyadic_Function
     Is_List_Function() : Polyadic_Function(1) {}
     Value call(Frame& args) override
     {
-        return {args[0].dycast<List>() != nullptr};
+        return {args[0].dycast_ptr<const List>() != nullptr};
+    }
+};
+struct Is_Stream_Function : public Polyadic_Function
+{
+    Is_Stream_Function() : Polyadic_Function(1) {}
+    Value call(Frame& args) override
+    {
+        return {args[0].dycast_ptr<const Stream>() != nullptr};
     }
 };
 struct Is_Record_Function : public Polyadic_Function
@@ -79,7 +93,7 @@ struct Is_Record_Function : public Polyadic_Function
     Is_Record_Function() : Polyadic_Function(1) {}
     Value call(Frame& args) override
     {
-        return {args[0].dycast<Structure>() != nullptr};
+        return {args[0].dycast_ptr<const Structure>() != nullptr};
     }
 };
 struct Is_Fun_Function : public Polyadic_Function
@@ -87,7 +101,7 @@ struct Is_Fun_Function : public Polyadic_Function
     Is_Fun_Function() : Polyadic_Function(1) {}
     Value call(Frame& args) override
     {
-        return {args[0].dycast<Function>() != nullptr};
+        return {args[0].dycast_ptr<const Function>() != nullptr};
     }
 };
 
@@ -329,7 +343,7 @@ struct Atan2_Function : public Polyadic_Function
 
 GL_Value gl_minmax(const char* name, Operation& argx, GL_Frame& f)
 {
-    auto list = dynamic_cast<List_Expr*>(&argx);
+    auto list = gl_list_literal(argx);
     if (list) {
         std::list<GL_Value> args;
         GL_Type type = GL_Type::Num;
@@ -503,11 +517,55 @@ struct Count_Function : public Polyadic_Function
     Count_Function() : Polyadic_Function(1) {}
     Value call(Frame& args) override
     {
-        if (auto list = args[0].dycast<const List>())
+        if (auto list = args[0].dycast_ptr<const List>())
             return {double(list->size())};
-        if (auto string = args[0].dycast<const String>())
-            return {double(string->size())};
-        throw Exception(At_Arg(args), "not a list or string");
+        if (auto string = String_Ref(args[0]))
+            return {double(string.size())};
+        if (auto stream = args[0].dycast_ptr<const Stream>()) {
+            At_Arg cx(args);
+            auto cur = stream->cursor();
+            Value val;
+            double n = 0;
+            while (cur->next(val, args)) {
+                if (Budget* b = thread_budget)
+                    budget_step(*b, 1, cx);
+                ++n;
+            }
+            return {n};
+        }
+        throw Exception(At_Arg(args), "not a list, string or stream");
+    }
+};
+// bench(f, n) calls the thunk `f()` n times, and returns the elapsed time
+// in seconds as a record {min, median, max}.
+struct Bench_Function : public Polyadic_Function
+{
+    Bench_Function() : Polyadic_Function(2) {}
+    Value call(Frame& args) override
+    {
+        auto fun = args[0].to<Function>(At_Arg(0, args));
+        int n = arg_to_int(args[1], 1, INT_MAX, At_Arg(1, args));
+        Value unit{List::make(0)};
+        std::vector<double> times;
+        // n can be huge: the vector grows as the calls are made.
+        times.reserve(std::min(n, 1024));
+        for (int i = 0; i < n; ++i) {
+            std::unique_ptr<Frame> f2 {
+                Frame::make(fun->nslots_, args.system_, &args,
+                    args.call_phrase_, nullptr)
+            };
+            auto start = std::chrono::steady_clock::now();
+            fun->call(unit, *f2);
+            auto end = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double>(end - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        auto result = make<Record>();
+        result->fields_["min"] = Value{times.front()};
+        result->fields_["median"] = Value{n % 2 ? times[n/2]
+            : (times[n/2 - 1] + times[n/2]) / 2};
+        result->fields_["max"] = Value{times.back()};
+        return {result};
     }
 };
 struct Fields_Function : public Polyadic_Function
@@ -526,15 +584,15 @@ struct Strcat_Function : public Polyadic_Function
     Strcat_Function() : Polyadic_Function(1) {}
     Value call(Frame& args) override
     {
-        if (auto list = args[0].dycast<const List>()) {
+        if (auto list = args[0].dycast_ptr<const List>()) {
             String_Builder sb;
             for (auto val : *list) {
-                if (auto str = val.dycast<const String>())
+                if (auto str = String_Ref(val))
                     sb << str;
                 else
                     sb << val;
             }
-            return {sb.get_string()};
+            return sb.get_value();
         }
         throw Exception(At_Arg(args), "not a list");
     }
@@ -546,7 +604,7 @@ struct Repr_Function : public Polyadic_Function
     {
         String_Builder sb;
         sb << args[0];
-        return {sb.get_string()};
+        return sb.get_value();
     }
 };
 struct Decode_Function : public Polyadic_Function
@@ -559,7 +617,7 @@ struct Decode_Function : public Polyadic_Function
         auto list = f[0].to<List>(cx);
         for (size_t i = 0; i < list->size(); ++i)
             sb << (char)arg_to_int((*list)[i], 1, 127, At_Index(i,cx));
-        return {sb.get_string()};
+        return sb.get_value();
     }
 };
 struct Encode_Function : public Polyadic_Function
@@ -569,13 +627,77 @@ struct Encode_Function : public Polyadic_Function
     {
         List_Builder lb;
         At_Arg cx(f);
-        auto str = f[0].to<String>(cx);
-        for (size_t i = 0; i < str->size(); ++i)
-            lb.push_back({(double)(int)str->at(i)});
+        auto str = value_to_string(f[0], cx);
+        for (size_t i = 0; i < str.size(); ++i)
+            lb.push_back({(double)(int)str[i]});
         return {lb.get_list()};
     }
 };
 
+// unfold(seed, step) is the stream generated by calling `step` on a state,
+// starting with `seed`. `step` returns null at the end of the stream,
+// otherwise [element, next_state].
+struct Unfold_Function : public Polyadic_Function
+{
+    Unfold_Function() : Polyadic_Function(2) {}
+    Value call(Frame& args) override
+    {
+        auto step = args[1].to<Function>(At_Arg(1, args));
+        return {make<Unfold_Stream>(args[0], step)};
+    }
+};
+// lazy_map(f, s) and lazy_filter(p, s) are the lazy versions of `map` and
+// `filter`, for a list or stream `s`. The std versions call these when
+// given a stream.
+struct Lazy_Map_Function : public Polyadic_Function
+{
+    Lazy_Map_Function() : Polyadic_Function(2) {}
+    Value call(Frame& args) override
+    {
+        auto fun = args[0].to<Function>(At_Arg(0, args));
+        make_cursor(args[1], At_Arg(1, args));
+        return {make<Map_Stream>(fun, args[1])};
+    }
+};
+struct Lazy_Filter_Function : public Polyadic_Function
+{
+    Lazy_Filter_Function() : Polyadic_Function(2) {}
+    Value call(Frame& args) override
+    {
+        auto pred = args[0].to<Function>(At_Arg(0, args));
+        make_cursor(args[1], At_Arg(1, args));
+        return {make<Filter_Stream>(pred, args[1])};
+    }
+};
+// take(n, s) is the stream of the first n elements of a list or stream.
+struct Take_Function : public Polyadic_Function
+{
+    Take_Function() : Polyadic_Function(2) {}
+    Value call(Frame& args) override
+    {
+        int n = arg_to_int(args[0], 0, INT_MAX, At_Arg(0, args));
+        make_cursor(args[1], At_Arg(1, args));
+        return {make<Take_Stream>(size_t(n), args[1])};
+    }
+};
+// memo s is a stream that caches the elements of `s` as they are computed.
+struct Memo_Function : public Polyadic_Function
+{
+    Memo_Function() : Polyadic_Function(1) {}
+    Value call(Frame& args) override
+    {
+        // Memo_Stream shares the ty_stream type code with the other streams,
+        // so dycast_ptr can't distinguish it: test the exact type.
+        if (args[0].is_ref()
+            && dynamic_cast<const Memo_Stream*>(&args[0].get_ref_unsafe()))
+        {
+            return args[0];
+        }
+        make_cursor(args[0], At_Arg(args));
+        return {make<Memo_Stream>(args[0])};
+    }
+};
+
 struct Match_Function : public Polyadic_Function
 {
     Match_Function() : Polyadic_Function(1) {}
@@ -610,15 +732,15 @@ struct File_Expr : public Just_Expression
         auto& callphrase = dynamic_cast<const Call_Phrase&>(*source_);
         At_Phrase cx(*callphrase.arg_, &f);
         Value arg = arg_->eval(f);
-        auto argstr = arg.to<String>(cx);
+        auto argstr = value_to_string(arg, cx);
         namespace fs = boost::filesystem;
         fs::path filepath;
         auto caller_script_name = source_->location().script().name_;
         if (caller_script_name->empty()) {
-            filepath = fs::path(argstr->c_str());
+            filepath = fs::path(argstr.c_str());
         } else {
             filepath = fs::path(caller_script_name->c_str()).parent_path()
-                / fs::path(argstr->c_str());
+                / fs::path(argstr.c_str());
         }
         auto file = make<File_Script>(make_string(filepath.c_str()), cx);
         Program prog{*file, f.system_};
@@ -637,6 +759,10 @@ struct File_Metafunction : public Metafunction
     }
 };
 
+// Serializes console output from definitions that are evaluated in parallel
+// (see Scope_Executable::exec_waves), so that lines aren't interleaved.
+static std::mutex console_mutex;
+
 /// The meaning of a call to `print`, such as `print "foo"`.
 struct Print_Action : public Just_Action
 {
@@ -651,8 +777,9 @@ struct Print_Action : public Just_Action
     virtual void exec(Frame& f) const override
     {
         Value arg = arg_->eval(f);
-        if (auto str = arg.dycast<String>())
-            f.system_.console() << *str;
+        std::lock_guard<std::mutex> lock(console_mutex);
+        if (auto str = String_Ref(arg))
+            f.system_.console() << str;
         else
             f.system_.console() << arg;
         f.system_.console() << std::endl;
@@ -681,12 +808,13 @@ struct Warning_Action : public Just_Action
     virtual void exec(Frame& f) const override
     {
         Value arg = arg_->eval(f);
-        Shared<String> msg;
-        if (auto str = arg.dycast<String>())
-            msg = str;
+        Shared<const String> msg;
+        if (auto str = String_Ref(arg))
+            msg = str.shared();
         else
             msg = stringify(arg);
         Exception exc{At_Phrase(*source_, &f), msg};
+        std::lock_guard<std::mutex> lock(console_mutex);
         f.system_.console() << "WARNING: " << exc << std::endl;
     }
 };
@@ -715,8 +843,8 @@ struct Error_Operation : public Operation
     {
         Value val = arg_->eval(f);
         Shared<const String> msg;
-        if (auto s = val.dycast<String>())
-            msg = s;
+        if (auto s = String_Ref(val))
+            msg = s.shared();
         else
             msg = stringify(val);
         throw Exception(At_Frame(&f), msg);
@@ -827,8 +955,8 @@ struct Assert_Error_Action : public Just_Action
     virtual void exec(Frame& f) const override
     {
         Value expected_msg_val = expected_message_->eval(f);
-        auto expected_msg_str = expected_msg_val.to<const String>(
-            At_Phrase(*expected_message_->source_, &f));
+        auto expected_msg_str = value_to_string(expected_msg_val,
+            At_Phrase(*expected_message_->source_, &f)).shared();
 
         if (actual_message_ != nullptr) {
             if (*actual_message_ != *expected_msg_str)
@@ -945,6 +1073,7 @@ builtin_namespace()
     {"is_string", make<Builtin_Value>(Value{make<Is_String_Function>()})},
     {"is_list", make<Builtin_Value>(Value{make<Is_List_Function>()})},
     {"is_record", make<Builtin_Value>(Value{make<Is_Record_Function>()})},
+    {"is_stream", make<Builtin_Value>(Value{make<Is_Stream_Function>()})},
     {"is_fun", make<Builtin_Value>(Value{make<Is_Fun_Function>()})},
     {"bit", make<Builtin_Value>(Value{make<Bit_Function>()})},
     {"sqrt", make<Builtin_Value>(Value{make<Sqrt_Function>()})},
@@ -962,12 +1091,18 @@ builtin_namespace()
     {"dot", make<Builtin_Value>(Value{make<Dot_Function>()})},
     {"mag", make<Builtin_Value>(Value{make<Mag_Function>()})},
     {"count", make<Builtin_Value>(Value{make<Count_Function>()})},
+    {"bench", make<Builtin_Value>(Value{make<Bench_Function>()})},
     {"fields", make<Builtin_Value>(Value{make<Fields_Function>()})},
     {"strcat", make<Builtin_Value>(Value{make<Strcat_Function>()})},
     {"repr", make<Builtin_Value>(Value{make<Repr_Function>()})},
     {"decode", make<Builtin_Value>(Value{make<Decode_Function>()})},
     {"encode", make<Builtin_Value>(Value{make<Encode_Function>()})},
     {"match", make<Builtin_Value>(Value{make<Match_Function>()})},
+    {"unfold", make<Builtin_Value>(Value{make<Unfold_Function>()})},
+    {"lazy_map", make<Builtin_Value>(Value{make<Lazy_Map_Function>()})},
+    {"lazy_filter", make<Builtin_Value>(Value{make<Lazy_Filter_Function>()})},
+    {"take", make<Builtin_Value>(Value{make<Take_Function>()})},
+    {"memo", make<Builtin_Value>(Value{make<Memo_Function>()})},
     {"file", make<Builtin_Meaning<File_Metafunction>>()},
     {"print", make<Builtin_Meaning<Print_Metafunction>>()},
     {"warning", make<Builtin_Meaning<Warning_Metafunction>>()},
@@ -36,7 +36,7 @@ struct Builtin_Meaning : public Builtin
     }
 };
 
-using Namespace = Atom_Map<Shared<const Builtin>>;
+using Namespace = Atom_Table<Shared<const Builtin>>;
 
 const Namespace& builtin_namespace();
 
@@ -63,13 +63,11 @@ Include_Definition::add_to_scope(Block_Scope& scope)
     auto val = std_eval(*arg_, scope);
     auto record = val.to<Structure>(At_Phrase(*arg_, scope));
 
-    // construct a Include_Setter from the record argument.
+    // The fields become constant bindings, which share the record's values.
+    // Nothing is copied at run time, when the scope is evaluated.
     unsigned unit = scope.begin_unit(share(*this));
-    setter_ = {Include_Setter::make(record->size(), source_)};
-    size_t i = 0;
     record->each_field([&](Atom name, Value value)->void {
-        slot_t slot = scope.add_binding(name, *source_, unit);
-        (*setter_)[i++] = {slot, value};
+        scope.add_constant(name, value, *source_, unit);
     });
     scope.end_unit(unit, share(*this));
 }
@@ -78,10 +76,9 @@ Include_Definition::analyse(Environ&)
 {
 }
 Shared<Operation>
-Include_Definition::make_setter(slot_t module_slot)
+Include_Definition::make_setter(slot_t)
 {
-    setter_->module_slot_ = module_slot;
-    return setter_;
+    return make<Null_Action>(source_);
 }
 
 void
@@ -105,12 +102,24 @@ Scope::add_binding(Atom name, const Phrase& unitsrc, unsigned unitno)
     dictionary_.emplace(std::make_pair(name, Binding{slot, unitno}));
     return slot;
 }
+void
+Scope::add_constant(Atom name, Value value, const Phrase& unitsrc,
+    unsigned unitno)
+{
+    if (dictionary_.find(name) != dictionary_.end())
+        throw Exception(At_Phrase(unitsrc, *parent_),
+            stringify(name, ": multiply defined"));
+    dictionary_.emplace(std::make_pair(name, Binding{value, unitno}));
+}
 Shared<Meaning>
 Scope::single_lookup(const Identifier& id)
 {
     auto b = dictionary_.find(id.atom_);
-    if (b != dictionary_.end())
+    if (b != dictionary_.end()) {
+        if (b->second.is_constant_)
+            return make<Constant>(share(id), b->second.value_);
         return make<Data_Ref>(share(id), b->second.slot_index_);
+    }
     return nullptr;
 }
 
@@ -120,10 +129,24 @@ Block_Scope::add_binding(Atom name, const Phrase& unitsrc, unsigned unitno)
     if (dictionary_.find(name) != dictionary_.end())
         throw Exception(At_Phrase(unitsrc, *parent_),
             stringify(name, ": multiply defined"));
-    slot_t slot = (target_is_module_ ? dictionary_.size() : make_slot());
+    slot_t slot = (target_is_module_ ? module_nslots_++ : make_slot());
     dictionary_.emplace(std::make_pair(name, Binding{slot, unitno}));
     return slot;
 }
+void
+Block_Scope::make_module_dictionary()
+{
+    auto d = make<Module::Dictionary>();
+    for (auto& b : dictionary_) {
+        if (b.second.is_constant_) {
+            (*d)[b.first] = Module::k_shared_slot | slot_t(d->shared_.size());
+            d->shared_.push_back(b.second.value_);
+        } else
+            (*d)[b.first] = b.second.slot_index_;
+    }
+    executable_.module_dictionary_ = d;
+    executable_.module_nslots_ = module_nslots_;
+}
 
 void
 Sequential_Scope::analyse(Definition& def)
@@ -131,12 +154,8 @@ Sequential_Scope::analyse(Definition& def)
     assert(def.kind_ == Definition::k_sequential);
     def.add_to_scope(*this);
     parent_->frame_maxslots_ = frame_maxslots_;
-    if (target_is_module_) {
-        auto d = make<Module::Dictionary>();
-        for (auto b : dictionary_)
-            (*d)[b.first] = b.second.slot_index_;
-        executable_.module_dictionary_ = d;
-    }
+    if (target_is_module_)
+        make_module_dictionary();
 }
 Shared<Meaning>
 Sequential_Scope::single_lookup(const Identifier& id)
@@ -144,7 +163,9 @@ Sequential_Scope::single_lookup(const Identifier& id)
     auto b = dictionary_.find(id.atom_);
     if (b != dictionary_.end()) {
         if (b->second.unit_index_ <= nunits_) {
-            if (target_is_module_) {
+            if (b->second.is_constant_) {
+                return make<Constant>(share(id), b->second.value_);
+            } else if (target_is_module_) {
                 return make<Module_Data_Ref>(
                     share(id), executable_.module_slot_, b->second.slot_index_);
             } else {
@@ -186,7 +207,13 @@ Recursive_Scope::analyse()
 {
     for (auto a : action_phrases_) {
         auto op = analyse_op(*a, *this);
+        // An action statement depends on every action before it, so that
+        // statements run in order, after the definitions they refer to.
+        unsigned level = 0;
+        for (auto l : action_levels_)
+            level = std::max(level, l + 1);
         executable_.actions_.push_back(op);
+        action_levels_.push_back(level);
     }
     for (auto& unit : units_) {
         if (unit.state_ == Unit::k_not_analysed)
@@ -194,11 +221,55 @@ Recursive_Scope::analyse()
     }
     parent_->frame_maxslots_ = frame_maxslots_;
     if (target_is_module_) {
-        auto d = make<Module::Dictionary>();
-        for (auto b : dictionary_)
-            (*d)[b.first] = b.second.slot_index_;
-        executable_.module_dictionary_ = d;
+        make_module_dictionary();
+        make_waves();
+    }
+}
+
+// Output the initialization action for a unit, or for the SCC `units`,
+// and record its dependency level.
+void
+Recursive_Scope::add_unit_action(
+    Shared<const Operation> action, size_t nunits, Unit** units)
+{
+    unsigned level = 0;
+    for (size_t u = 0; u < nunits; ++u) {
+        for (auto d : units[u]->deps_) {
+            // Units in the same SCC don't have an action yet.
+            int a = units_[d].action_;
+            if (a >= 0)
+                level = std::max(level, action_levels_[a] + 1);
+        }
+    }
+    int index = executable_.actions_.size();
+    executable_.actions_.push_back(std::move(action));
+    action_levels_.push_back(level);
+    for (size_t u = 0; u < nunits; ++u)
+        units[u]->action_ = index;
+}
+
+// Group the actions of a module by dependency level, so that
+// Scope_Executable::eval_module can run independent definitions in parallel.
+// This is only worthwhile for a level with two or more data definitions:
+// function definitions just construct closures.
+void
+Recursive_Scope::make_waves()
+{
+    std::vector<Scope_Executable::Wave> waves;
+    std::vector<unsigned> ndata;
+    bool parallel = false;
+    for (unsigned i = 0; i < action_levels_.size(); ++i) {
+        unsigned l = action_levels_[i];
+        if (l >= waves.size()) {
+            waves.resize(l + 1);
+            ndata.resize(l + 1, 0);
+        }
+        waves[l].actions_.push_back(i);
+        if (isa<const Pattern_Setter>(executable_.actions_[i]) && ++ndata[l] > 1)
+            waves[l].parallel_ = parallel = true;
     }
+    if (parallel)
+        executable_.waves_ = std::move(waves);
 }
 
 // Analyse the unitary definition `unit` that belongs to the scope,
@@ -267,8 +338,9 @@ Recursive_Scope::analyse_unit(Unit& unit, const Identifier* id)
             assert(scc_stack_.back() == &unit);
             scc_stack_.pop_back();
             unit.state_ = Unit::k_analysed;
-            executable_.actions_.push_back(
-                unit.def_->make_setter(executable_.module_slot_));
+            Unit* u = &unit;
+            add_unit_action(
+                unit.def_->make_setter(executable_.module_slot_), 1, &u);
         } else {
             // Output a Function_Setter to initialize the slots for a group of
             // mutually recursive functions, or a single nonrecursive function.
@@ -278,8 +350,9 @@ Recursive_Scope::analyse_unit(Unit& unit, const Identifier* id)
                 ++ui;
             assert(scc_stack_[ui] == &unit);
 
-            executable_.actions_.push_back(
-                make_function_setter(scc_stack_.size()-ui, &scc_stack_[ui]));
+            size_t n = scc_stack_.size()-ui;
+            add_unit_action(
+                make_function_setter(n, &scc_stack_[ui]), n, &scc_stack_[ui]);
             Unit* u;
             do {
                 assert(scc_stack_.size() > 0);
@@ -345,7 +418,11 @@ Recursive_Scope::single_lookup(const Identifier& id)
     auto b = dictionary_.find(id.atom_);
     if (b != dictionary_.end()) {
         analyse_unit(units_[b->second.unit_index_], &id);
-        if (target_is_module_) {
+        if (!analysis_stack_.empty())
+            analysis_stack_.back()->deps_.push_back(b->second.unit_index_);
+        if (b->second.is_constant_) {
+            return make<Constant>(share(id), b->second.value_);
+        } else if (target_is_module_) {
             return make<Module_Data_Ref>(
                 share(id), executable_.module_slot_, b->second.slot_index_);
         } else {
@@ -100,7 +100,6 @@ struct Data_Definition : public Unitary_Definition
 struct Include_Definition : public Unitary_Definition
 {
     Shared<Phrase> arg_;
-    Shared<Include_Setter> setter_; // initialized by add_to_scope()
 
     Include_Definition(
         Shared<const Phrase> source,
@@ -139,15 +138,26 @@ struct Scope : public Environ
     struct Binding {
         slot_t slot_index_;
         unsigned unit_index_;
+        // A binding made by `include` is a compile time constant: it has
+        // no slot, and references to it are replaced by its value.
+        bool is_constant_ = false;
+        Value value_ = {};
 
         Binding(slot_t slot, unsigned unit)
         :
             slot_index_(slot),
             unit_index_(unit)
         {}
+        Binding(Value value, unsigned unit)
+        :
+            slot_index_((slot_t)(-1)),
+            unit_index_(unit),
+            is_constant_(true),
+            value_(value)
+        {}
     };
 
-    Atom_Map<Binding> dictionary_ = {};
+    Atom_Table<Binding> dictionary_ = {};
 
     Scope(Environ& parent)
     :
@@ -159,12 +169,14 @@ struct Scope : public Environ
 
     virtual Shared<Meaning> single_lookup(const Identifier&) override;
     virtual slot_t add_binding(Atom, const Phrase&, unsigned unit);
+    void add_constant(Atom, Value, const Phrase&, unsigned unit);
 };
 
 struct Block_Scope : public Scope
 {
     bool target_is_module_;
     Scope_Executable executable_ = {};
+    slot_t module_nslots_ = 0;
 
     Block_Scope(Environ& parent, bool target_is_module)
     :
@@ -176,6 +188,7 @@ struct Block_Scope : public Scope
     }
 
     virtual slot_t add_binding(Atom, const Phrase&, unsigned unit) override;
+    void make_module_dictionary();
 
     virtual void analyse(Definition&) = 0;
     virtual void add_action(Shared<const Phrase>) = 0;
@@ -212,6 +225,8 @@ struct Recursive_Scope : public Block_Scope
         int scc_ord_ = -1; // -1 until SCC assigned
         int scc_lowlink_ = -1;
         Atom_Map<Shared<Operation>> nonlocals_ = {};
+        std::vector<unsigned> deps_ = {}; // units referenced by this unit
+        int action_ = -1; // index of initialization action, once output
 
         Unit(Shared<Unitary_Definition> def) : def_(def) {}
 
@@ -242,6 +257,11 @@ struct Recursive_Scope : public Block_Scope
     std::vector<Unit*> scc_stack_ = {};
     std::vector<Unit*> analysis_stack_ = {};
 
+    // Dependency level of each action in executable_.actions_: 0 if it
+    // depends on no other action, otherwise 1 + the maximum level of the
+    // actions it depends on. Actions with the same level are independent.
+    std::vector<unsigned> action_levels_ = {};
+
     Recursive_Scope(
         Environ& parent, bool target_is_module, Shared<const Phrase> source)
     :
@@ -252,6 +272,8 @@ struct Recursive_Scope : public Block_Scope
 
     void analyse_unit(Unit&, const Identifier*);
     Shared<Operation> make_function_setter(size_t nunits, Unit** units);
+    void add_unit_action(Shared<const Operation>, size_t nunits, Unit** units);
+    void make_waves();
     void analyse();
 
     virtual Shared<Meaning> single_lookup(const Identifier&) override;
@@ -10,9 +10,14 @@
 #include <curv/list.h>
 #include <curv/record.h>
 #include <curv/module.h>
+#include <curv/stream.h>
 #include <curv/context.h>
 #include <curv/array_op.h>
+#include <curv/worker_pool.h>
+#include <atomic>
+#include <climits>
 #include <cmath>
+#include <mutex>
 #include <curv/math.h>
 
 namespace curv {
@@ -22,6 +27,12 @@ Operation::eval(Frame& f) const
 {
     throw Exception(At_Phrase(*source_, &f), "not an expression");
 }
+const Value&
+Operation::eval_ref(Frame& f, Value& tmp) const
+{
+    tmp = eval(f);
+    return tmp;
+}
 void
 Operation::exec(Frame& f) const
 {
@@ -65,6 +76,11 @@ Constant::eval(Frame&) const
 {
     return value_;
 }
+const Value&
+Constant::eval_ref(Frame&, Value&) const
+{
+    return value_;
+}
 
 Value
 Symbolic_Ref::eval(Frame& f) const
@@ -82,33 +98,51 @@ Module_Data_Ref::eval(Frame& f) const
     assert(m.type_ == Ref_Value::ty_module);
     return m.at(index_);
 }
+const Value&
+Module_Data_Ref::eval_ref(Frame& f, Value&) const
+{
+    Module& m = (Module&)f[slot_].get_ref_unsafe();
+    assert(m.type_ == Ref_Value::ty_module);
+    return m.at(index_);
+}
 
 Value
 Nonlocal_Data_Ref::eval(Frame& f) const
 {
     return f.nonlocals_->at(slot_);
 }
+const Value&
+Nonlocal_Data_Ref::eval_ref(Frame& f, Value&) const
+{
+    return f.nonlocals_->at(slot_);
+}
 
 Value
 Data_Ref::eval(Frame& f) const
 {
     return f[slot_];
 }
+const Value&
+Data_Ref::eval_ref(Frame& f, Value&) const
+{
+    return f[slot_];
+}
 
 Value
 Dot_Expr::eval(Frame& f) const
 {
-    Value basev = base_->eval(f);
+    Value tmp;
+    const Value& basev = base_->eval_ref(f, tmp);
     Atom id = selector_.eval(f);
     return basev.at(id, At_Phrase(*base_->source_, &f));
 }
 
 Value
-eval_not(Value x, const Context& cx)
+eval_not(const Value& x, const Context& cx)
 {
     if (x.is_bool())
         return {!x.get_bool_unsafe()};
-    if (auto xlist = x.dycast<List>()) {
+    if (auto xlist = x.dycast_ptr<const List>()) {
         Shared<List> result = List::make(xlist->size());
         for (unsigned i = 0; i < xlist->size(); ++i)
             (*result)[i] = eval_not((*xlist)[i], cx);
@@ -119,7 +153,8 @@ eval_not(Value x, const Context& cx)
 Value
 Not_Expr::eval(Frame& f) const
 {
-    return eval_not(arg_->eval(f), At_Phrase(*source_, &f));
+    Value tmp;
+    return eval_not(arg_->eval_ref(f, tmp), At_Phrase(*source_, &f));
 }
 
 Value
@@ -132,7 +167,8 @@ Positive_Expr::eval(Frame& f) const
         }
     };
     static Unary_Numeric_Array_Op<Scalar_Op> array_op;
-    return array_op.op(arg_->eval(f), At_Phrase(*source_, &f));
+    Value tmp;
+    return array_op.op(arg_->eval_ref(f, tmp), At_Phrase(*source_, &f));
 }
 Value
 Negative_Expr::eval(Frame& f) const
@@ -144,14 +180,16 @@ Negative_Expr::eval(Frame& f) const
         }
     };
     static Unary_Numeric_Array_Op<Scalar_Op> array_op;
-    return array_op.op(arg_->eval(f), At_Phrase(*source_, &f));
+    Value tmp;
+    return array_op.op(arg_->eval_ref(f, tmp), At_Phrase(*source_, &f));
 }
 
 Value
 Add_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     return add(a,b, At_Phrase(*source_, &f));
 }
 Value
@@ -165,15 +203,17 @@ Subtract_Expr::eval(Frame& f) const
         }
     };
     static Binary_Numeric_Array_Op<Scalar_Op> array_op;
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     return array_op.op(a,b, At_Phrase(*source_, &f));
 }
 Value
 Multiply_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     return multiply(a,b, At_Phrase(*source_, &f));
 }
 Value
@@ -187,8 +227,9 @@ Divide_Expr::eval(Frame& f) const
         }
     };
     static Binary_Numeric_Array_Op<Scalar_Op> array_op;
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     return array_op.op(a,b, At_Phrase(*source_, &f));
 }
 
@@ -308,22 +349,25 @@ If_Else_Op::exec(Frame& f) const
 Value
 Equal_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     return {a == b};
 }
 Value
 Not_Equal_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     return {a != b};
 }
 Value
 Less_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     // only 2 comparisons required to unbox two numbers and compare them, not 3
     if (a.get_num_or_nan() < b.get_num_or_nan())
         return {true};
@@ -335,8 +379,9 @@ Less_Expr::eval(Frame& f) const
 Value
 Greater_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     // only 2 comparisons required to unbox two numbers and compare them, not 3
     if (a.get_num_or_nan() > b.get_num_or_nan())
         return {true};
@@ -348,8 +393,9 @@ Greater_Expr::eval(Frame& f) const
 Value
 Less_Or_Equal_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     // only 2 comparisons required to unbox two numbers and compare them, not 3
     if (a.get_num_or_nan() <= b.get_num_or_nan())
         return {true};
@@ -361,8 +407,9 @@ Less_Or_Equal_Expr::eval(Frame& f) const
 Value
 Greater_Or_Equal_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
     // only 2 comparisons required to unbox two numbers and compare them, not 3
     if (a.get_num_or_nan() >= b.get_num_or_nan())
         return {true};
@@ -382,13 +429,16 @@ Power_Expr::eval(Frame& f) const
         }
     };
     static Binary_Numeric_Array_Op<Scalar_Op> array_op;
-    return array_op.op(arg1_->eval(f), arg2_->eval(f), At_Phrase(*source_, &f));
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
+    return array_op.op(a, b, At_Phrase(*source_, &f));
 }
 
 Value
 list_at(const List& list, Value index, const Context& cx)
 {
-    if (auto indices = index.dycast<List>()) {
+    if (auto indices = index.dycast_ptr<const List>()) {
         Shared<List> result = List::make(indices->size());
         int j = 0;
         for (auto i : *indices)
@@ -401,45 +451,58 @@ list_at(const List& list, Value index, const Context& cx)
 Value
 struct_at(const Structure& ref, Value index, const Context& cx)
 {
-    if (auto indices = index.dycast<List>()) {
+    if (auto indices = index.dycast_ptr<const List>()) {
         Shared<List> result = List::make(indices->size());
         int j = 0;
         for (auto i : *indices)
             (*result)[j++] = struct_at(ref, i, cx);
         return {result};
     }
-    Atom a = index.to<const String>(cx);
-    return ref.getfield(a, cx);
+    // Usually an inline string: look it up without allocating an Atom.
+    return ref.getfield(value_to_string(index, cx).c_str(), cx);
 }
 Value
-string_at(const String& string, Value index, const Context& cx)
+string_at(const String_Ref& string, Value index, const Context& cx)
 {
     // TODO: this code only works for ASCII strings.
-    if (auto indices = index.dycast<List>()) {
+    if (auto indices = index.dycast_ptr<const List>()) {
         String_Builder sb;
         for (auto ival : *indices) {
             int i = arg_to_int(ival, 0, (int)(string.size()-1), cx);
             sb << string[i];
         }
-        return {sb.get_string()};
+        return sb.get_value();
     }
     int i = arg_to_int(index, 0, (int)(string.size()-1), cx);
-    return {String::make(string.data()+i, 1)};
+    return make_string_value(string.data()+i, 1);
 }
 Value
-value_at_path(Value a, const List& path, const Context& cx)
+stream_at(const Stream& stream, Value index, Frame& f, const Context& cx)
+{
+    if (auto indices = index.dycast_ptr<const List>()) {
+        Shared<List> result = List::make(indices->size());
+        int j = 0;
+        for (auto i : *indices)
+            (*result)[j++] = stream_at(stream, i, f, cx);
+        return {result};
+    }
+    int i = arg_to_int(index, 0, INT_MAX, cx);
+    return stream.at(i, f, cx);
+}
+Value
+value_at_path(Value a, const List& path, Frame& f, const Context& cx)
 {
     At_Index icx(0, cx);
     for (size_t i = 0; i < path.size(); ++i) {
         icx.index_ = i;
-        if (auto string = a.dycast<String>()) {
+        if (auto string = String_Ref(a)) {
             if (i < path.size()-1) {
                 throw Exception(icx,
                     "string used with multidimensional indexing (like string[i,j])");
             }
-            return string_at(*string, path[i], icx);
+            return string_at(string, path[i], icx);
         }
-        if (auto list = a.dycast<List>()) {
+        if (auto list = a.dycast_ptr<const List>()) {
             if (i < path.size()-1) {
                 int j = arg_to_int(path[i], 0, (int)(list->size()-1), icx);
                 a = list->at(j);
@@ -447,35 +510,55 @@ value_at_path(Value a, const List& path, const Context& cx)
                 a = list_at(*list, path[i], icx);
             continue;
         }
-        throw Exception(icx, "not list or string");
+        if (auto stream = a.dycast_ptr<const Stream>()) {
+            if (i < path.size()-1) {
+                int j = arg_to_int(path[i], 0, INT_MAX, icx);
+                a = stream->at(j, f, icx);
+            } else
+                a = stream_at(*stream, path[i], f, icx);
+            continue;
+        }
+        throw Exception(icx, "not list, string or stream");
     }
     return a;
 }
 Value
 Index_Expr::eval(Frame& f) const
 {
-    Value a = arg1_->eval(f);
-    Value b = arg2_->eval(f);
-    if (auto list = a.dycast<const List>())
+    Value ta, tb;
+    const Value& a = arg1_->eval_ref(f, ta);
+    const Value& b = arg2_->eval_ref(f, tb);
+    if (auto list = a.dycast_ptr<const List>())
         return list_at(*list, b, At_Phrase(*arg2_->source_, &f));
-    if (auto structure = a.dycast<const Structure>())
+    if (auto structure = a.dycast_ptr<const Structure>())
         return struct_at(*structure, b, At_Phrase(*arg2_->source_, &f));
-    if (auto string = a.dycast<const String>())
-        return string_at(*string, b, At_Phrase(*arg2_->source_, &f));
+    if (auto string = String_Ref(a))
+        return string_at(string, b, At_Phrase(*arg2_->source_, &f));
+    if (auto stream = a.dycast_ptr<const Stream>())
+        return stream_at(*stream, b, f, At_Phrase(*arg2_->source_, &f));
     throw Exception(At_Phrase(*arg1_->source_, &f),
-        "not a list, record or string");
+        "not a list, record, string or stream");
 }
 Value
 Call_Expr::eval(Frame& f) const
 {
     static Atom callkey = "call";
-    Value val = fun_->eval(f);
-    Value funv = val;
+    if (Budget* b = thread_budget)
+        budget_step(*b, 1, At_Phrase(*source_, &f));
+    Value tmp;
+    const Value& val = fun_->eval_ref(f, tmp);
+    const Value* funv = &val;
+    Value callv;
     for (;;) {
-        if (!funv.is_ref())
+        if (funv->is_inline_string()) {
+            At_Phrase cx(*arg_->source_, &f);
+            Value arg = arg_->eval(f);
+            return value_at_path(*funv, arg.to_ref<const List>(cx), f, cx);
+        }
+        if (!funv->is_ref())
             throw Exception(At_Phrase(*fun_->source_, &f),
-                stringify(funv,": not a function"));
-        Ref_Value& funp( funv.get_ref_unsafe() );
+                stringify(*funv,": not a function"));
+        Ref_Value& funp( funv->get_ref_unsafe() );
         switch (funp.type_) {
         case Ref_Value::ty_function:
           {
@@ -490,17 +573,19 @@ Call_Expr::eval(Frame& f) const
           {
             Structure* s = (Structure*)&funp;
             if (s->hasfield(callkey)) {
-                funv = s->getfield(callkey, {});
+                callv = s->getfield(callkey, {});
+                funv = &callv;
                 continue;
             }
             break;
           }
         case Ref_Value::ty_string:
         case Ref_Value::ty_list:
+        case Ref_Value::ty_stream:
           {
             At_Phrase cx(*arg_->source_, &f);
-            auto path = arg_->eval(f).to<List>(cx);
-            return value_at_path(funv, *path, cx);
+            Value arg = arg_->eval(f);
+            return value_at_path(*funv, arg.to_ref<const List>(cx), f, cx);
           }
         }
         throw Exception(At_Phrase(*fun_->source_, &f),
@@ -528,15 +613,17 @@ List_Expr_Base::eval(Frame& f) const
 void
 Spread_Op::generate(Frame& f, List_Builder& lb) const
 {
-    auto list = arg_->eval(f).to<const List>(At_Phrase(*arg_->source_, &f));
-    for (size_t i = 0; i < list->size(); ++i)
-        lb.push_back(list->at(i));
+    Value arg = arg_->eval(f);
+    auto& list = arg.to_ref<const List>(At_Phrase(*arg_->source_, &f));
+    for (size_t i = 0; i < list.size(); ++i)
+        lb.push_back(list.at(i));
 }
 void
 Spread_Op::bind(Frame& f, Record& r) const
 {
-    auto s = arg_->eval(f).to<const Structure>(At_Phrase(*arg_->source_, &f));
-    s->putfields(r.fields_);
+    Value arg = arg_->eval(f);
+    arg.to_ref<const Structure>(At_Phrase(*arg_->source_, &f))
+        .putfields(r.fields_);
 }
 
 void
@@ -562,12 +649,98 @@ Scope_Executable::eval_module(Frame& f) const
     assert(module_dictionary_ != nullptr);
 
     Shared<Module> module =
-        Module::make(module_dictionary_->size(), module_dictionary_);
+        Module::make(module_nslots_, module_dictionary_);
     f[module_slot_] = {module};
-    for (auto action : actions_)
-        action->exec(f);
+    // A budget counts steps on one thread, so it forces serial evaluation.
+    if (waves_.empty() || thread_budget != nullptr || eval_threads() < 2) {
+        for (auto action : actions_)
+            action->exec(f);
+    } else
+        exec_waves(f);
     return module;
 }
+
+// Execute the actions of a module constructor, one wave at a time.
+//
+// The actions of a parallel wave are claimed one at a time by the current
+// thread and by the threads of the worker pool (see run_on_workers).
+// Nested scopes use frame slots above module_slot_ for temporary values, so
+// each worker has its own frame, with a copy of the slots up to module_slot_.
+// Those are not modified while the module is being evaluated. The module's
+// own slots are shared: each action initializes different slots.
+//
+// The result is the same as for serial evaluation, including which error
+// is reported: if any action fails, the unfinished actions that precede it
+// in serial order are run serially, and the first error is rethrown.
+void
+Scope_Executable::exec_waves(Frame& f) const
+{
+    size_t nactions = actions_.size();
+    std::vector<char> done(nactions, 0);
+    size_t failed = nactions;
+    std::exception_ptr error;
+
+    for (auto& wave : waves_) {
+        if (!wave.parallel_) {
+            for (auto a : wave.actions_) {
+                try {
+                    actions_[a]->exec(f);
+                    done[a] = 1;
+                } catch (...) {
+                    failed = a;
+                    error = std::current_exception();
+                    break;
+                }
+            }
+        } else {
+            std::atomic<size_t> next{0};
+            std::atomic<bool> stop{false};
+            std::mutex error_mutex;
+            run_on_workers([&](bool on_worker) -> void {
+                std::unique_ptr<Frame> copy;
+                Frame* tf = &f;
+                if (on_worker) {
+                    try {
+                        copy = Frame::make(f.size_, f.system_,
+                            f.parent_frame_, f.call_phrase_, f.nonlocals_);
+                    } catch (...) {
+                        return;
+                    }
+                    for (slot_t i = 0; i <= module_slot_; ++i)
+                        (*copy)[i] = f[i];
+                    tf = copy.get();
+                }
+                for (;;) {
+                    size_t w = next++;
+                    if (w >= wave.actions_.size() || stop)
+                        return;
+                    unsigned a = wave.actions_[w];
+                    try {
+                        actions_[a]->exec(*tf);
+                        done[a] = 1;
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (a < failed) {
+                            failed = a;
+                            error = std::current_exception();
+                        }
+                        stop = true;
+                    }
+                }
+            });
+        }
+        if (failed < nactions)
+            break;
+    }
+    if (failed < nactions) {
+        for (size_t a = 0; a < failed; ++a) {
+            if (!done[a])
+                actions_[a]->exec(f);
+        }
+        std::rethrow_exception(error);
+    }
+}
+
 void
 Scope_Executable::exec(Frame& f) const
 {
@@ -689,6 +862,8 @@ void
 While_Action::exec(Frame& f) const
 {
     for (;;) {
+        if (Budget* b = thread_budget)
+            budget_step(*b, 1, At_Phrase(*source_, &f));
         Value c = cond_->eval(f);
         bool b = c.to_bool(At_Phrase{*cond_->source_, &f});
         if (!b) return;
@@ -696,58 +871,77 @@ While_Action::exec(Frame& f) const
     }
 }
 
+// Call `body` on each element of the list, range or stream in a `for` loop,
+// after binding the element to the pattern. A range is iterated without
+// building a list, and a stream is pulled one element at a time, so a loop
+// over a large sequence runs in constant memory.
+template <class Body>
 void
-For_Op::generate(Frame& f, List_Builder& lb) const
+for_each_element(const For_Op& op, Frame& f, Body body)
 {
-    At_Phrase cx{*list_->source_, &f};
+    At_Phrase cx{*op.list_->source_, &f};
     At_Index icx{0, cx};
-    Value listval = list_->eval(f);
+    if (auto range = dynamic_cast<const Range_Expr*>(&*op.list_)) {
+        double first, step;
+        unsigned count = range->eval_range(f, first, step);
+        for (unsigned i = 0; i < count; ++i) {
+            if (Budget* b = thread_budget)
+                budget_step(*b, 1, cx);
+            icx.index_ = i;
+            op.pattern_->exec(f.array_, Value{first + step*i}, icx, f);
+            body();
+        }
+        return;
+    }
+    Value listval = op.list_->eval(f);
+    if (auto stream = listval.dycast_ptr<const Stream>()) {
+        auto cur = stream->cursor();
+        Value elem;
+        for (size_t i = 0; cur->next(elem, f); ++i) {
+            if (Budget* b = thread_budget)
+                budget_step(*b, 1, cx);
+            icx.index_ = i;
+            op.pattern_->exec(f.array_, elem, icx, f);
+            body();
+        }
+        return;
+    }
     List& list = arg_to_list(listval, cx);
     for (size_t i = 0; i < list.size(); ++i) {
+        if (Budget* b = thread_budget)
+            budget_step(*b, 1, cx);
         icx.index_ = i;
-        pattern_->exec(f.array_, list[i], icx, f);
-        body_->generate(f, lb);
+        op.pattern_->exec(f.array_, list[i], icx, f);
+        body();
     }
 }
 void
+For_Op::generate(Frame& f, List_Builder& lb) const
+{
+    for_each_element(*this, f, [&]() { body_->generate(f, lb); });
+}
+void
 For_Op::bind(Frame& f, Record& r) const
 {
-    At_Phrase cx{*list_->source_, &f};
-    At_Index icx{0, cx};
-    Value listval = list_->eval(f);
-    List& list = arg_to_list(listval, cx);
-    for (size_t i = 0; i < list.size(); ++i) {
-        icx.index_ = i;
-        pattern_->exec(f.array_, list[i], icx, f);
-        body_->bind(f, r);
-    }
+    for_each_element(*this, f, [&]() { body_->bind(f, r); });
 }
 void
 For_Op::exec(Frame& f) const
 {
-    At_Phrase cx{*list_->source_, &f};
-    At_Index icx{0, cx};
-    Value listval = list_->eval(f);
-    List& list = arg_to_list(listval, cx);
-    for (size_t i = 0; i < list.size(); ++i) {
-        icx.index_ = i;
-        pattern_->exec(f.array_, list[i], icx, f);
-        body_->exec(f);
-    }
+    for_each_element(*this, f, [&]() { body_->exec(f); });
 }
 
-Value
-Range_Expr::eval(Frame& f) const
+unsigned
+Range_Expr::eval_range(Frame& f, double& first, double& step) const
 {
-    List_Builder lb;
     Value firstv = arg1_->eval(f);
-    double first = firstv.get_num_or_nan();
+    first = firstv.get_num_or_nan();
 
     Value lastv = arg2_->eval(f);
     double last = lastv.get_num_or_nan();
 
     Value stepv;
-    double step = 1.0;
+    step = 1.0;
     if (arg3_) {
         stepv = arg3_->eval(f);
         step = stepv.get_num_or_nan();
@@ -758,19 +952,28 @@ Range_Expr::eval(Frame& f) const
     // Note: countd could be infinity. It could be too large to fit in an
     // integer. It could be a float integer too large to increment (for large
     // float i, i==i+1). So we impose a limit on the count.
-    if (countd < 1'000'000'000.0) {
-        unsigned count = (unsigned) countd;
-        for (unsigned i = 0; i < count; ++i)
-            lb.push_back(Value{first + step*i});
-    } else {
-        const char* err =
-            (countd == countd ? "too many elements in range" : "domain error");
-        const char* dots = (half_open_ ? "..<" : "..");
-        throw Exception(At_Phrase(*source_, &f),
-            arg3_
-                ? stringify(firstv,dots,lastv," by ",stepv,": ", err)
-                : stringify(firstv,dots,lastv,": ", err));
+    if (countd < 1'000'000'000.0)
+        return (unsigned) countd;
+    const char* err =
+        (countd == countd ? "too many elements in range" : "domain error");
+    const char* dots = (half_open_ ? "..<" : "..");
+    throw Exception(At_Phrase(*source_, &f),
+        arg3_
+            ? stringify(firstv,dots,lastv," by ",stepv,": ", err)
+            : stringify(firstv,dots,lastv,": ", err));
+}
+Value
+Range_Expr::eval(Frame& f) const
+{
+    List_Builder lb;
+    double first, step;
+    unsigned count = eval_range(f, first, step);
+    if (Budget* b = thread_budget) {
+        budget_step(*b, count, At_Phrase(*source_, &f));
+        budget_alloc(count * sizeof(Value));
     }
+    for (unsigned i = 0; i < count; ++i)
+        lb.push_back(Value{first + step*i});
     return {lb.get_list()};
 }
 
@@ -798,16 +1001,17 @@ void
 Bracket_Segment::generate(Frame& f, String_Builder& sb) const
 {
     At_Phrase cx(*expr_->source_,&f);
-    auto list = expr_->eval(f).to<List>(cx);
-    for (size_t i = 0; i < list->size(); ++i)
-        sb << (char)arg_to_int((*list)[i], 1, 127, At_Index(i,cx));
+    Value val = expr_->eval(f);
+    auto& list = val.to_ref<const List>(cx);
+    for (size_t i = 0; i < list.size(); ++i)
+        sb << (char)arg_to_int(list[i], 1, 127, At_Index(i,cx));
 }
 void
 Brace_Segment::generate(Frame& f, String_Builder& sb) const
 {
     Value val = expr_->eval(f);
-    if (auto str = val.dycast<String>())
-        sb << *str;
+    if (auto str = String_Ref(val))
+        sb << str;
     else
         sb << val;
 }
@@ -817,7 +1021,7 @@ String_Expr_Base::eval(Frame& f) const
     String_Builder sb;
     for (auto seg : *this)
         seg->generate(f, sb);
-    return {sb.get_string()};
+    return sb.get_value();
 }
 Atom
 String_Expr_Base::eval_atom(Frame& f) const
@@ -862,20 +1066,4 @@ Function_Setter_Base::exec(Frame& f) const
         slots[e.slot_] = {make<Closure>(*e.lambda_, *nonlocals)};
 }
 
-void
-Include_Setter_Base::exec(Frame& f) const
-{
-    Value* slots;
-    if (module_slot_ == (slot_t)(-1))
-        slots = &f[0];
-    else {
-        auto mval = f[module_slot_];
-        auto m = (Module*)&mval.get_ref_unsafe();
-        assert(m->type_ == Ref_Value::ty_module);
-        slots = &m->at(0);
-    }
-    for (auto& e : *this)
-        slots[e.slot_] = e.value_;
-}
-
 } // namespace curv
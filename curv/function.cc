@@ -32,7 +32,7 @@ Polyadic_Function::call(Value arg, Frame& f)
         f[0] = arg;
         return call(f);
     }
-    auto list = arg.dycast<const List>();
+    auto list = arg.dycast_ptr<const List>();
     if (list && list->size() == nargs_) {
         for (size_t i = 0; i < list->size(); ++i)
             f[i] = (*list)[i];
@@ -50,7 +50,7 @@ Polyadic_Function::try_call(Value arg, Frame& f)
         f[0] = arg;
         return call(f);
     }
-    auto list = arg.dycast<const List>();
+    auto list = arg.dycast_ptr<const List>();
     if (list && list->size() == nargs_) {
         for (size_t i = 0; i < list->size(); ++i)
             f[i] = (*list)[i];
@@ -68,7 +68,7 @@ const
     auto f2 = GL_Frame::make(nslots_, f.gl, nullptr, &f, call_phrase);
     if (nargs_ == 1)
         (*f2)[0] = arg.gl_eval(f);
-    else if (auto list = dynamic_cast<List_Expr*>(&arg)) {
+    else if (auto list = gl_list_literal(arg)) {
         if (list->size() != nargs_)
             throw Exception(At_GL_Phrase(arg.source_, &f), stringify(
                 "wrong number of arguments (got ",list->size(),
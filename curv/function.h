@@ -22,6 +22,7 @@ struct Function : public Ref_Value
         Ref_Value(ty_function),
         nslots_(nslots)
     {}
+    static bool has_type(uint32_t ty) { return ty == ty_function; }
 
     // call the function during evaluation
     virtual Value call(Value, Frame&) = 0;
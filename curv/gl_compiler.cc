@@ -3,6 +3,7 @@
 // See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
 
 #include <cctype>
+#include <sstream>
 #include <typeinfo>
 #include <boost/core/demangle.hpp>
 #include <curv/context.h>
@@ -14,6 +15,7 @@
 #include <curv/gl_context.h>
 #include <curv/meaning.h>
 #include <curv/shape.h>
+#include <curv/trace.h>
 
 namespace curv {
 
@@ -22,6 +24,7 @@ void gl_compile_3d(const Shape_Recognizer&, std::ostream&, const Context&);
 
 void gl_compile(const Shape_Recognizer& shape, std::ostream& out, const Context& cx)
 {
+    Trace_Scope trace("gl_compile");
     if (shape.is_2d_)
         return gl_compile_2d(shape, out, cx);
     if (shape.is_3d_)
@@ -29,24 +32,38 @@ void gl_compile(const Shape_Recognizer& shape, std::ostream& out, const Context&
     die("gl_compile: shape is not 2d or 3d");
 }
 
+// Constant array initializers need GLSL 1.20, but a shader without a
+// #version directive is compiled as GLSL 1.10. The directive must precede
+// everything else, so it is only emitted for shaders that use arrays:
+// other shaders are left unversioned.
+void gl_put_version(const GL_Compiler& gl, std::ostream& out)
+{
+    if (!gl.constants.str().empty())
+        out << "#version 120\n";
+}
+
 void gl_compile_2d(const Shape_Recognizer& shape, std::ostream& out, const Context& cx)
 {
-    GL_Compiler gl(out);
+    // The function body is compiled first, since it may declare
+    // constant arrays that must precede it.
+    std::stringstream body;
+    GL_Compiler gl(body);
     GL_Value dist_param = gl.newvalue(GL_Type::Vec4);
 
-    out <<
-        "#ifdef GLSLVIEWER\n"
-        "uniform mat3 u_view2d;\n"
-        "#endif\n"
-        "float main_dist(vec4 " << dist_param << ", out vec4 colour)\n"
-        "{\n";
-
     GL_Value result = shape.gl_dist(dist_param, gl);
 
     GL_Value colour = shape.gl_colour(dist_param, gl);
-    out << "  colour = vec4(" << colour << ", 1.0);\n";
+    body << "  colour = vec4(" << colour << ", 1.0);\n";
 
+    gl_put_version(gl, out);
     out <<
+        "#ifdef GLSLVIEWER\n"
+        "uniform mat3 u_view2d;\n"
+        "#endif\n"
+        << gl.constants.str() <<
+        "float main_dist(vec4 " << dist_param << ", out vec4 colour)\n"
+        "{\n"
+        << body.str() <<
         "  return " << result << ";\n"
         "}\n";
     BBox bbox = shape.bbox_;
@@ -92,25 +109,27 @@ void gl_compile_2d(const Shape_Recognizer& shape, std::ostream& out, const Conte
 
 void gl_compile_3d(const Shape_Recognizer& shape, std::ostream& out, const Context& cx)
 {
-    GL_Compiler gl(out);
+    std::stringstream body;
+    GL_Compiler gl(body);
     GL_Value dist_param = gl.newvalue(GL_Type::Vec4);
 
+    GL_Value result = shape.gl_dist(dist_param, gl);
+
+    GL_Value colour = shape.gl_colour(dist_param, gl);
+    body << "  return vec4(" << result << ",";
+    body << colour << ");\n";
+
+    gl_put_version(gl, out);
     out <<
         "#ifdef GLSLVIEWER\n"
         "uniform vec3 u_eye3d;\n"
         "uniform vec3 u_centre3d;\n"
         "uniform vec3 u_up3d;\n"
         "#endif\n"
+        << gl.constants.str() <<
         "vec4 map(vec4 " << dist_param << ")\n"
-        "{\n";
-
-    GL_Value result = shape.gl_dist(dist_param, gl);
-
-    GL_Value colour = shape.gl_colour(dist_param, gl);
-    out << "  return vec4(" << result << ",";
-    out << colour << ");\n";
-
-    out <<
+        "{\n"
+        << body.str() <<
         "}\n";
 
     BBox bbox = shape.bbox_;
@@ -553,11 +572,11 @@ GL_Value Power_Expr::gl_eval(GL_Frame& f) const
 
 // Evaluate an expression to a constant at GL compile time,
 // or abort if it isn't a constant.
-Value gl_constify(Operation& op, GL_Frame& f)
+Value gl_constify(const Operation& op, GL_Frame& f)
 {
-    if (auto c = dynamic_cast<Constant*>(&op))
+    if (auto c = dynamic_cast<const Constant*>(&op))
         return c->value_;
-    else if (auto dot = dynamic_cast<Dot_Expr*>(&op)) {
+    else if (auto dot = dynamic_cast<const Dot_Expr*>(&op)) {
         Value base = gl_constify(*dot->base_, f);
         if (dot->selector_.id_ != nullptr)
             return base.at(dot->selector_.id_->atom_,
@@ -566,20 +585,25 @@ Value gl_constify(Operation& op, GL_Frame& f)
             throw Exception(At_GL_Phrase(dot->selector_.string_->source_, &f),
                 "Geometry Compiler: not an identifier");
     }
-    else if (auto ref = dynamic_cast<Nonlocal_Data_Ref*>(&op))
+    else if (auto ref = dynamic_cast<const Nonlocal_Data_Ref*>(&op))
         return f.nonlocals_->at(ref->slot_);
-    else if (auto ref = dynamic_cast<Symbolic_Ref*>(&op)) {
+    else if (auto ref = dynamic_cast<const Data_Ref*>(&op)) {
+        auto c = f.constants_.find(ref->slot_);
+        if (c != f.constants_.end())
+            return c->second;
+    }
+    else if (auto ref = dynamic_cast<const Symbolic_Ref*>(&op)) {
         auto b = f.nonlocals_->dictionary_->find(ref->name_);
         assert(b != f.nonlocals_->dictionary_->end());
         return f.nonlocals_->get(b->second);
     }
-    else if (auto list = dynamic_cast<List_Expr*>(&op)) {
+    else if (auto list = dynamic_cast<const List_Expr*>(&op)) {
         Shared<List> listval = List::make(list->size());
         for (size_t i = 0; i < list->size(); ++i) {
             (*listval)[i] = gl_constify(*(*list)[i], f);
         }
         return {listval};
-    } else if (auto neg = dynamic_cast<Negative_Expr*>(&op)) {
+    } else if (auto neg = dynamic_cast<const Negative_Expr*>(&op)) {
         Value arg = gl_constify(*neg->arg_, f);
         if (arg.is_num())
             return Value(-arg.get_num_unsafe());
@@ -588,6 +612,113 @@ Value gl_constify(Operation& op, GL_Frame& f)
         "Geometry Compiler: not a constant");
 }
 
+Shared<List_Expr> gl_list_literal(Operation& op)
+{
+    if (auto list = dynamic_cast<List_Expr*>(&op))
+        return share(*list);
+    if (auto c = dynamic_cast<Constant*>(&op)) {
+        if (auto listval = c->value_.dycast_ptr<const List>()) {
+            auto list = List_Expr::make(listval->size(), c->source_);
+            for (size_t i = 0; i < listval->size(); ++i)
+                (*list)[i] = make<Constant>(c->source_, (*listval)[i]);
+            return list;
+        }
+    }
+    return nullptr;
+}
+
+// Write a constant array element as a GLSL expression. Returns false if
+// the element is not of type `type`.
+static bool
+gl_put_array_elem(std::ostream& out, Value elem, GL_Type type)
+{
+    if (type == GL_Type::Num) {
+        if (!elem.is_num()) return false;
+        out << dfmt(elem.get_num_unsafe(), dfmt::EXPR);
+        return true;
+    }
+    if (type == GL_Type::Bool) {
+        if (!elem.is_bool()) return false;
+        out << (elem.get_bool_unsafe() ? "true" : "false");
+        return true;
+    }
+    auto vec = elem.dycast_ptr<const List>();
+    if (vec == nullptr || vec->size() != gl_type_count(type))
+        return false;
+    out << type << "(";
+    bool first = true;
+    for (auto e : *vec) {
+        if (!e.is_num()) return false;
+        if (!first) out << ",";
+        first = false;
+        out << dfmt(e.get_num_unsafe(), dfmt::EXPR);
+    }
+    out << ")";
+    return true;
+}
+
+bool gl_try_const_array(const Operation& op, GL_Frame& f, GL_Array& arr)
+{
+    Value val;
+    try {
+        val = gl_constify(op, f);
+    } catch (Exception&) {
+        return false;
+    }
+    auto list = val.dycast_ptr<const List>();
+    if (list == nullptr)
+        return false;
+    if (list->size() >= 2 && list->size() <= 4 && list->front().is_num())
+        return false; // a vector
+    auto found = f.gl.arrays.find(list);
+    if (found != f.gl.arrays.end()) {
+        arr = found->second;
+        return true;
+    }
+
+    arr.index = f.gl.arrays.size();
+    arr.size = list->size();
+    arr.elem_type = GL_Type::Num;
+    if (arr.size > 0) {
+        Value e = list->front();
+        if (e.is_bool())
+            arr.elem_type = GL_Type::Bool;
+        else if (auto vec = e.dycast_ptr<const List>()) {
+            if (vec->size() >= 2 && vec->size() <= 4)
+                arr.elem_type = gl_vec_type(vec->size());
+        }
+        std::ostream& out = f.gl.constants;
+        out << "const " << arr.elem_type << " " << arr << "[" << arr.size
+            << "] = " << arr.elem_type << "[" << arr.size << "](";
+        for (size_t i = 0; i < list->size(); ++i) {
+            if (i > 0) out << ",";
+            if (!gl_put_array_elem(out, (*list)[i], arr.elem_type)) {
+                throw Exception(At_Index(i, At_GL_Phrase(op.source_, &f)),
+                    stringify("Geometry Compiler: array element ",(*list)[i],
+                        " is not a ",arr.elem_type));
+            }
+        }
+        out << ");\n";
+    }
+    f.gl.arrays[list] = arr;
+    f.gl.array_values.push_back(val);
+    return true;
+}
+
+// Index a constant array. Curv indexes with a number, GLSL with an int.
+GL_Value gl_eval_array_index(
+    GL_Array arr, Operation& index, GL_Frame& f)
+{
+    if (arr.size == 0)
+        throw Exception(At_GL_Phrase(index.source_, &f),
+            "Geometry Compiler: can't index an empty list");
+    auto i = gl_eval_expr(f, index, GL_Type::Num);
+    GL_Value result = f.gl.newvalue(arr.elem_type);
+    f.gl.out << "  " << result.type << " " << result << " = "
+        << arr << "[int(" << i << ")];\n";
+    return result;
+}
+
 bool gl_try_eval(Operation& op, GL_Frame& f, GL_Value& val)
 {
     try {
@@ -714,18 +845,25 @@ GL_Value gl_eval_index_expr(
 
 GL_Value Index_Expr::gl_eval(GL_Frame& f) const
 {
+    GL_Array arr;
+    if (gl_try_const_array(*arg1_, f, arr))
+        return gl_eval_array_index(arr, *arg2_, f);
     auto arg1 = arg1_->gl_eval(f);
     return gl_eval_index_expr(arg1, *arg1_->source_, *arg2_, f);
 }
 
 GL_Value Call_Expr::gl_eval(GL_Frame& f) const
 {
+    GL_Array arr;
+    bool is_array = gl_try_const_array(*fun_, f, arr);
     GL_Value glval;
-    if (gl_try_eval(*fun_, f, glval)) {
-        auto list = cast<List_Expr>(arg_);
+    if (is_array || gl_try_eval(*fun_, f, glval)) {
+        auto list = gl_list_literal(*arg_);
         if (list == nullptr || list->size() != 1)
             throw Exception(At_GL_Phrase(arg_->source_, &f),
                 "Geometry Compiler: expected '[index]' expression");
+        if (is_array)
+            return gl_eval_array_index(arr, *list->at(0), f);
         return gl_eval_index_expr(glval, *fun_->source_, *list->at(0), f);
     }
     Value val = gl_constify(*fun_, f);
@@ -749,6 +887,9 @@ GL_Value Call_Expr::gl_eval(GL_Frame& f) const
 
 GL_Value Data_Ref::gl_eval(GL_Frame& f) const
 {
+    auto c = f.constants_.find(slot_);
+    if (c != f.constants_.end())
+        return gl_eval_const(f, c->second, *source_);
     return f[slot_];
 }
 
@@ -860,12 +1001,58 @@ void While_Action::gl_exec(GL_Frame& f) const
     body_->gl_exec(f);
     f.gl.out << "  }\n";
 }
+// True if `val` can be an element of a GL constant array.
+static bool
+gl_is_array_elem(Value val)
+{
+    if (val.is_num() || val.is_bool())
+        return true;
+    auto vec = val.dycast_ptr<const List>();
+    return vec != nullptr && vec->size() >= 2 && vec->size() <= 4
+        && vec->front().is_num();
+}
+
 void For_Op::gl_exec(GL_Frame& f) const
 {
     auto range = cast<const Range_Expr>(list_);
-    if (range == nullptr)
-        throw Exception(At_GL_Phrase(list_->source_, &f),
-            "GL: not a range");
+    if (range == nullptr) {
+        // A constant list of values that have no GL representation
+        // (eg, a list of shapes) is unrolled at compile time.
+        Value listval;
+        try {
+            listval = gl_constify(*list_, f);
+        } catch (Exception&) {
+        }
+        auto list = listval.dycast_ptr<const List>();
+        if (list != nullptr && list->size() > 0
+            && !gl_is_array_elem(list->front()))
+        {
+            for (size_t i = 0; i < list->size(); ++i) {
+                pattern_->gl_exec_const((*list)[i],
+                    At_Index(i, At_GL_Phrase(list_->source_, &f)), f);
+                body_->gl_exec(f);
+            }
+            return;
+        }
+
+        // Iterate over a constant array.
+        GL_Array arr;
+        if (!gl_try_const_array(*list_, f, arr))
+            throw Exception(At_GL_Phrase(list_->source_, &f),
+                "GL: not a range or a constant list");
+        if (arr.size == 0)
+            return;
+        auto i = f.gl.newvalue(GL_Type::Num);
+        f.gl.out << "  for (int " << i << "=0;" << i << "<" << arr.size << ";"
+                 << "++" << i << ") {\n";
+        auto elem = f.gl.newvalue(arr.elem_type);
+        f.gl.out << "  " << elem.type << " " << elem << " = "
+                 << arr << "[" << i << "];\n";
+        pattern_->gl_exec(elem, At_GL_Phrase(list_->source_,&f), f);
+        body_->gl_exec(f);
+        f.gl.out << "  }\n";
+        return;
+    }
     /*
     auto first = gl_eval_expr(f, *range->arg1_, GL_Type::Num);
     auto last = gl_eval_expr(f, *range->arg2_, GL_Type::Num);
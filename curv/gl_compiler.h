@@ -5,7 +5,9 @@
 #ifndef CURV_GL_COMPILER_H
 #define CURV_GL_COMPILER_H
 
+#include <map>
 #include <ostream>
+#include <sstream>
 #include <vector>
 #include <curv/tail_array.h>
 #include <curv/module.h>
@@ -114,12 +116,40 @@ inline std::ostream& operator<<(std::ostream& out, GL_Value v)
     return out;
 }
 
+/// A constant array, declared at global scope in the generated GLSL.
+/// Lists that don't map onto a GL vector, such as a list of polygon vertices,
+/// are compiled into constant arrays, and are accessed by indexing or
+/// by a `for` loop. The shader size doesn't grow with the length of the list.
+struct GL_Array
+{
+    unsigned index;
+    GL_Type elem_type;
+    unsigned size;
+};
+
+/// print the GLSL array name
+inline std::ostream& operator<<(std::ostream& out, GL_Array a)
+{
+    out << "a" << a.index;
+    return out;
+}
+
 /// Global state for the GLSL code generator.
 struct GL_Compiler
 {
     std::ostream& out;
     unsigned valcount;
 
+    /// Declarations of constant arrays. These are output at global scope,
+    /// ahead of the function that references them.
+    std::stringstream constants;
+
+    /// Constant arrays that have been declared, indexed by the List they
+    /// were generated from. The List values are retained, so that the keys
+    /// stay unique during compilation.
+    std::map<const List*, GL_Array> arrays;
+    std::vector<Value> array_values;
+
     GL_Compiler(std::ostream& s) : out(s), valcount(0) {}
 
     inline GL_Value newvalue(GL_Type type)
@@ -189,6 +219,14 @@ struct GL_Frame_Base
     /// * nullptr, for a call to a builtin function.
     Module* nonlocals_;
 
+    /// Local slots bound to compile time constants, rather than GL_Values.
+    ///
+    /// A `for` loop over a constant list of values that have no GL
+    /// representation (such as the operands of an n-ary union) is unrolled,
+    /// and the loop variable is bound here. Calls through these values,
+    /// like `shape.dist p`, are then compiled as calls to known functions.
+    std::map<slot_t, Value> constants_;
+
     // Tail array, containing the slots used for local bindings:
     // function arguments, block bindings and other local, temporary values.
     using value_type = GL_Value;
@@ -217,6 +255,15 @@ struct GL_Frame_Base
 
 GL_Value gl_eval_expr(GL_Frame&, const Operation& op, GL_Type);
 GL_Value gl_eval_const(GL_Frame& f, Value val, const Phrase&);
+
+// If `op` is a list literal, return it as a List_Expr, otherwise nullptr.
+// The analyser folds a list literal with constant elements into a Constant:
+// in that case, a List_Expr of Constants is reconstructed.
+Shared<List_Expr> gl_list_literal(Operation& op);
+
+// If `op` is a compile time constant list that isn't a GL vector,
+// declare it as a constant array (once per list value) and return true.
+bool gl_try_const_array(const Operation& op, GL_Frame& f, GL_Array& arr);
 GL_Value gl_call_unary_numeric(GL_Frame&, const char*);
 void gl_put_as(GL_Frame& f, GL_Value val, const Context&, GL_Type type);
 GL_Value gl_vec_element(GL_Frame&, GL_Value, int);
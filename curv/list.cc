@@ -4,6 +4,7 @@
 
 #include <curv/list.h>
 #include <curv/exception.h>
+#include <curv/printer.h>
 
 namespace curv {
 
@@ -21,12 +22,7 @@ const
 void
 List_Base::print(std::ostream& out) const
 {
-    out << "[";
-    for (size_t i = 0; i < size(); ++i) {
-        if (i > 0) out << ",";
-        array_[i].print(out);
-    }
-    out << "]";
+    Value_Printer(out).print(*this);
 }
 
 auto List_Base::operator==(const List_Base& list) const
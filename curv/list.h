@@ -17,6 +17,7 @@ struct Context;
 struct List_Base : public Ref_Value
 {
     List_Base() : Ref_Value(ty_list) {}
+    static bool has_type(uint32_t ty) { return ty == ty_list; }
     virtual void print(std::ostream&) const;
     bool operator==(const List_Base&) const;
     void assert_size(size_t sz, const Context& cx) const;
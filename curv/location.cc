@@ -17,41 +17,35 @@ auto Location::line_info() const
     //   Use prev line #, col == # chars in line including newline.
     // - Empty range, first==last, ambiguous (only happens for EOF token):
     //   Use prev line #, col == # chars in line including newline.
+    //
+    // The script's line index gives the line number of a character position
+    // in O(log n), using the "next line" rule. `prev_line(i)` gives the
+    // "previous line" rule, used for the end of a range.
+    const Script& s = *script_;
+    auto prev_line = [&](uint32_t i) -> unsigned {
+        return i == 0 ? 0 : s.line_num(i-1);
+    };
     Line_Info info;
-    unsigned lineno = 0;
-    unsigned colno = 0;
-    unsigned linebegin = 0;
-    for (uint32_t i = 0; i <= token_.last_; ++i) {
-        if (i == token_.first_) {
-            info.start_line_num = lineno;
-            info.start_column_num = colno;
-            info.start_line_begin = linebegin;
-        }
-        if (i == token_.last_) {
-            info.end_line_num = lineno;
-            info.end_column_num = colno;
-        }
-        if (i > 0 && (*script_)[i-1] == '\n') {
-            // ambiguous character position, see above.
-            ++lineno;
-            linebegin = i;
-            colno = 0;
-            if (i == token_.first_) {
-                if (token_.first_ == token_.last_) {
-                    // a zero-length EOF token, preceded by \n.
-                    // Moving the token to precede the \n so that the
-                    // caret is positioned in a more readable place for write().
-                    --info.start_column_num;
-                    --info.end_column_num;
-                } else {
-                    // a non-empty token that starts at the beginning of a line
-                    info.start_line_num = lineno;
-                    info.start_column_num = colno;
-                    info.start_line_begin = linebegin;
-                }
-            }
-        }
-        ++colno;
+
+    unsigned endline = prev_line(token_.last_);
+    info.end_line_num = endline;
+    info.end_column_num = token_.last_ - s.line_begin(endline);
+
+    if (token_.first_ == token_.last_
+        && token_.first_ > 0 && s[token_.first_-1] == '\n')
+    {
+        // a zero-length EOF token, preceded by \n.
+        // Moving the token to precede the \n so that the
+        // caret is positioned in a more readable place for write().
+        info.start_line_num = endline;
+        info.start_line_begin = s.line_begin(endline);
+        --info.end_column_num;
+        info.start_column_num = info.end_column_num;
+    } else {
+        unsigned startline = s.line_num(token_.first_);
+        info.start_line_num = startline;
+        info.start_line_begin = s.line_begin(startline);
+        info.start_column_num = token_.first_ - info.start_line_begin;
     }
     return info;
 }
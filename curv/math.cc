@@ -10,7 +10,7 @@ namespace curv {
 
 struct Context;
 
-Value add(Value a, Value b, const Context& cx)
+Value add(const Value& a, const Value& b, const Context& cx)
 {
     struct Scalar_Op {
         static double f(double x, double y) { return x + y; }
@@ -23,7 +23,7 @@ Value add(Value a, Value b, const Context& cx)
     return array_op.op(a, b, cx);
 }
 
-Value multiply(Value a, Value b, const Context& cx)
+Value multiply(const Value& a, const Value& b, const Context& cx)
 {
     struct Scalar_Op {
         static double f(double x, double y) { return x * y; }
@@ -47,7 +47,7 @@ Value dot(Value a, Value b, const Context& cx)
 {
     auto av = a.to<List>(cx);
     auto bv = b.to<List>(cx);
-    if (av->size() > 0 && av->at(0).dycast<List>()) {
+    if (av->size() > 0 && av->at(0).dycast_ptr<const List>()) {
         Shared<List> result = List::make(av->size());
         for (size_t i = 0; i < av->size(); ++i) {
             result->at(i) = dot(av->at(i), b, cx);
@@ -15,8 +15,8 @@ struct Context;
 // Same as Mathematica Dot[A,B]. Like APL A+.×B, Python numpy.dot(A,B)
 Value dot(Value a, Value b, const Context& cx);
 
-Value add(Value a, Value b, const Context& cx);
-Value multiply(Value a, Value b, const Context& cx);
+Value add(const Value& a, const Value& b, const Context& cx);
+Value multiply(const Value& a, const Value& b, const Context& cx);
 
 } // namespace curv
 #endif // header guard
@@ -93,6 +93,19 @@ struct Operation : public Meaning
     // These functions are called during evaluation.
     virtual Value eval(Frame&) const;
     virtual void generate(Frame&, List_Builder&) const;
+
+    // Evaluate an expression without taking ownership of the result.
+    // The default stores `eval(f)` in `tmp` and returns `tmp`. Variable
+    // references and constants instead return a borrowed reference to the
+    // slot or constant, saving a refcount increment and decrement.
+    //
+    // A borrowed reference stays valid while the caller evaluates sibling
+    // expression operands in the same frame: an expression can't reassign
+    // a variable from an enclosing scope (see Environ::lookup_var), and the
+    // slot of a variable that is in scope is never reused by a nested scope.
+    // It is not valid across the execution of an action, which may reassign
+    // the variable.
+    virtual const Value& eval_ref(Frame& f, Value& tmp) const;
     virtual void bind(Frame&, Record&) const;
     virtual void exec(Frame&) const;
 
@@ -154,6 +167,7 @@ struct Constant : public Just_Expression
     {}
 
     virtual Value eval(Frame&) const override;
+    virtual const Value& eval_ref(Frame&, Value&) const override;
     virtual GL_Value gl_eval(GL_Frame&) const override;
 };
 
@@ -188,6 +202,7 @@ struct Module_Data_Ref : public Just_Expression
     {}
 
     virtual Value eval(Frame&) const override;
+    virtual const Value& eval_ref(Frame&, Value&) const override;
 };
 
 /// reference to a strict nonlocal slot (nonrecursive lambda nonlocal)
@@ -200,6 +215,7 @@ struct Nonlocal_Data_Ref : public Just_Expression
     {}
 
     virtual Value eval(Frame&) const override;
+    virtual const Value& eval_ref(Frame&, Value&) const override;
     virtual GL_Value gl_eval(GL_Frame&) const override;
 };
 
@@ -212,6 +228,7 @@ struct Data_Ref : public Just_Expression
     {}
 
     virtual Value eval(Frame&) const override;
+    virtual const Value& eval_ref(Frame&, Value&) const override;
     virtual GL_Value gl_eval(GL_Frame&) const override;
 };
 
@@ -408,6 +425,10 @@ struct Range_Expr : public Just_Expression
         half_open_(half_open)
     {}
     virtual Value eval(Frame&) const override;
+
+    /// Evaluate the arguments, store the first element and the step,
+    /// and return the number of elements, without building a list.
+    unsigned eval_range(Frame&, double& first, double& step) const;
 };
 
 struct List_Expr_Base : public Just_Expression
@@ -443,9 +464,23 @@ struct Scope_Executable
     // For a block, nullptr.
     Shared<Module::Dictionary> module_dictionary_ = nullptr;
 
+    // For a module constructor, the number of slots in the module.
+    // Fields defined by `include` are stored in the dictionary, not in slots.
+    slot_t module_nslots_ = 0;
+
     // actions to execute at runtime: action statements and slot initialization
     std::vector<Shared<const Operation>> actions_ = {};
 
+    // For a module constructor, the indexes of actions_ grouped into waves.
+    // The actions in a wave depend only on actions in earlier waves.
+    // A wave is executed in parallel if it has two or more data definitions.
+    // Empty if no wave is parallel.
+    struct Wave {
+        std::vector<unsigned> actions_;
+        bool parallel_ = false;
+    };
+    std::vector<Wave> waves_ = {};
+
     Scope_Executable() {}
 
     /// Initialize the module slot, execute the definitions and action list.
@@ -453,6 +488,8 @@ struct Scope_Executable
     Shared<Module> eval_module(Frame&) const;
     void exec(Frame&) const;
     void gl_exec(GL_Frame&) const;
+private:
+    void exec_waves(Frame&) const;
 };
 
 // An internal action for storing the value of a data definition
@@ -616,24 +653,6 @@ struct Function_Setter_Base : public Just_Action
 };
 using Function_Setter = Tail_Array<Function_Setter_Base>;
 
-struct Include_Setter_Base : public Just_Action
-{
-    slot_t module_slot_ = (slot_t)(-1);
-
-    using Just_Action::Just_Action;
-
-    void exec(Frame&) const override;
-
-    struct Element {
-        slot_t slot_;
-        Value value_;
-        Element(slot_t s, Value v) : slot_(s), value_(v) {}
-        Element() noexcept {}
-    };
-    TAIL_ARRAY_MEMBERS(Element)
-};
-using Include_Setter = Tail_Array<Include_Setter_Base>;
-
 struct Compound_Op_Base : public Operation
 {
     Compound_Op_Base(Shared<const Phrase> source)
@@ -4,6 +4,7 @@
 
 #include <curv/module.h>
 #include <curv/function.h>
+#include <curv/printer.h>
 
 namespace curv {
 
@@ -12,15 +13,7 @@ const char Module_Base::name[] = "module";
 void
 Module_Base::print(std::ostream& out) const
 {
-    out << "{";
-    bool first = true;
-    for (auto i : *this) {
-        if (!first) out << ",";
-        first = false;
-        out << i.first << ":";
-        i.second.print(out);
-    }
-    out << "}";
+    Value_Printer(out).print(*this);
 }
 
 void
@@ -33,6 +26,8 @@ Module_Base::putfields(Atom_Map<Value>& out) const
 Value
 Module_Base::get(slot_t i) const
 {
+    if (i & k_shared_slot)
+        return dictionary_->shared_[i & ~k_shared_slot];
     Value val = array_[i];
     if (val.is_ref()) {
         auto& ref = val.get_ref_unsafe();
@@ -51,6 +46,15 @@ Module_Base::getfield(Atom name, const Context& cx) const
     return Structure::getfield(name, cx);
 }
 
+Value
+Module_Base::getfield(const char* name, const Context& cx) const
+{
+    auto b = dictionary_->find(name);
+    if (b != dictionary_->end())
+        return get(b->second);
+    return Structure::getfield(Atom(name), cx);
+}
+
 bool
 Module_Base::hasfield(Atom name) const
 {
@@ -5,6 +5,7 @@
 #ifndef CURV_MODULE_H
 #define CURV_MODULE_H
 
+#include <vector>
 #include <curv/structure.h>
 #include <curv/atom.h>
 #include <curv/shared.h>
@@ -30,7 +31,14 @@ struct Module_Base : public Structure
     struct Dictionary : public Shared_Base, public Atom_Map<slot_t>
     {
         Dictionary() : Shared_Base(), Atom_Map<slot_t>() {}
+
+        /// Values of the fields defined by `include`. These are compile time
+        /// constants, the same in every module that shares this dictionary,
+        /// so they are stored once, here, instead of in each module's slots.
+        /// Such a field is mapped to `k_shared_slot|i`, an index into shared_.
+        std::vector<Value> shared_ = {};
     };
+    static constexpr slot_t k_shared_slot = slot_t(1) << 31;
 
     /// The `dictionary` maps field names onto slot indexes.
     ///
@@ -56,6 +64,7 @@ struct Module_Base : public Structure
         Structure(ty_module),
         dictionary_(std::move(dictionary))
     {}
+    static bool has_type(uint32_t ty) { return ty == ty_module; }
 
     /// Fetch the contents of slot index `i`, normalize to a proper Value.
     Value get(slot_t i) const;
@@ -98,9 +107,10 @@ struct Module_Base : public Structure
     virtual void print(std::ostream&) const override;
 
     virtual Value getfield(Atom, const Context&) const override;
+    virtual Value getfield(const char*, const Context&) const override;
     virtual bool hasfield(Atom) const override;
     virtual void putfields(Atom_Map<Value>&) const override;
-    virtual size_t size() const override { return size_; }
+    virtual size_t size() const override { return dictionary_->size(); }
     virtual Shared<List> fields() const override;
     virtual void each_field(std::function<void(Atom,Value)>) const override;
 
@@ -61,6 +61,12 @@ struct Id_Pattern : public Pattern
     const override
     {
         callee[slot_] = value;
+        callee.constants_.erase(slot_);
+    }
+    virtual void gl_exec_const(Value value, const Context&, GL_Frame& callee)
+    const override
+    {
+        callee.constants_[slot_] = value;
     }
     virtual void gl_exec(Operation& expr, GL_Frame& caller, GL_Frame& callee)
     const override
@@ -72,6 +78,7 @@ struct Id_Pattern : public Pattern
         GL_Value var = caller.gl.newvalue(val.type);
         caller.gl.out << "  "<<var.type<<" "<<var<<"="<<val<<";\n";
         callee[slot_] = var;
+        callee.constants_.erase(slot_);
     }
 };
 
@@ -196,15 +203,15 @@ struct List_Pattern : public Pattern
     virtual void exec(Value* slots, Value val, const Context& valcx, Frame& f)
     const override
     {
-        auto list = val.to<List>(valcx);
-        list->assert_size(items_.size(), valcx);
+        auto& list = val.to_ref<const List>(valcx);
+        list.assert_size(items_.size(), valcx);
         for (size_t i = 0; i < items_.size(); ++i)
-            items_[i]->exec(slots, list->at(i), At_Index(i, valcx), f);
+            items_[i]->exec(slots, list.at(i), At_Index(i, valcx), f);
     }
     virtual bool try_exec(Value* slots, Value val, Frame& f)
     const override
     {
-        auto list = val.dycast<List>();
+        auto list = val.dycast_ptr<const List>();
         if (list == nullptr)
             return false;
         if (list->size() != items_.size())
@@ -217,7 +224,7 @@ struct List_Pattern : public Pattern
     virtual void gl_exec(Operation& expr, GL_Frame& caller, GL_Frame& callee)
     const override
     {
-        if (auto list = dynamic_cast<List_Expr*>(&expr)) {
+        if (auto list = gl_list_literal(expr)) {
             if (list->size() != items_.size()) {
                 throw Exception(At_GL_Phrase(expr.source_, &caller),
                     stringify("list pattern: expected ",items_.size(),
@@ -322,7 +329,7 @@ struct Record_Pattern : public Pattern
     const override
     {
         // TODO: clean this up OMG. Need a general Record iterator.
-        auto record = value.dycast<Structure>();
+        auto record = value.dycast_ptr<const Structure>();
         if (record == nullptr)
             return false;
         auto p = fields_.begin();
@@ -378,8 +385,8 @@ atomize(const Phrase& ph, Scope& scope)
         return id->atom_;
     if (auto strph = dynamic_cast<const String_Phrase*>(&ph)) {
         auto val = std_eval(*strph, scope);
-        auto str = val.to<const String>(At_Phrase(ph, scope));
-        return Atom{str};
+        auto str = value_to_string(val, At_Phrase(ph, scope));
+        return Atom{str.shared()};
     }
     throw Exception(At_Phrase(ph, scope),
         "not an identifier or string literal");
@@ -477,5 +484,11 @@ Pattern::gl_exec(Operation& expr, GL_Frame& caller, GL_Frame& callee) const
     throw Exception(At_GL_Phrase(source_, &callee),
         "pattern not supported by Geometry Compiler");
 }
+void
+Pattern::gl_exec_const(Value, const Context&, GL_Frame& callee) const
+{
+    throw Exception(At_GL_Phrase(source_, &callee),
+        "pattern not supported by Geometry Compiler");
+}
 
 } // namespace curv
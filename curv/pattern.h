@@ -27,6 +27,9 @@ struct Pattern : public Shared_Base
     virtual bool try_exec(Value* slots, Value, Frame&) const = 0;
     virtual void gl_exec(GL_Value, const Context&, GL_Frame&) const;
     virtual void gl_exec(Operation& expr, GL_Frame& caller, GL_Frame& callee) const;
+    /// Bind a compile time constant, in a loop unrolled by the
+    /// Geometry Compiler. See GL_Frame_Base::constants_.
+    virtual void gl_exec_const(Value, const Context&, GL_Frame&) const;
 };
 
 Shared<Pattern> make_pattern(const Phrase&, Scope&, unsigned unitno);
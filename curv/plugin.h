@@ -0,0 +1,33 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef CURV_PLUGIN_H
+#define CURV_PLUGIN_H
+
+#include <curv/builtin.h>
+
+namespace curv {
+
+/// A native plugin is a shared library that adds builtin bindings to the
+/// std namespace. Typically these are Polyadic_Function subclasses that
+/// implement `call` for the evaluator and `gl_call` for the Geometry Compiler,
+/// so that a hot function runs at native speed in both.
+///
+/// The plugin defines its entry point using this macro:
+///
+///     CURV_PLUGIN_INIT(names)
+///     {
+///         names["noise"] = make<Builtin_Value>(Value{make<Noise_Function>()});
+///     }
+///
+/// A plugin is compiled against the same libcurv headers as the executable
+/// that loads it, and libcurv symbols are resolved against that executable,
+/// which must be linked with exported symbols.
+#define CURV_PLUGIN_INIT(names) \
+    extern "C" void curv_plugin_init(curv::Namespace& names)
+
+using Plugin_Init_Function = void (*)(Namespace&);
+
+} // namespace curv
+#endif // header guard
@@ -0,0 +1,204 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#include <curv/printer.h>
+#include <curv/dtostr.h>
+#include <curv/list.h>
+#include <curv/module.h>
+#include <curv/record.h>
+#include <curv/string.h>
+#include <cmath>
+#include <cstring>
+
+namespace curv {
+
+bool
+Value_Printer::room(size_t n)
+{
+    if (truncated_)
+        return false;
+    if (limit_ != 0 && count_ + n > limit_) {
+        truncated_ = true;
+        if (len_ + 3 > sizeof(buf_)) flush();
+        memcpy(buf_ + len_, "...", 3);
+        len_ += 3;
+        return false;
+    }
+    count_ += n;
+    return true;
+}
+
+void
+Value_Printer::put(const char* str, size_t n)
+{
+    if (!room(n))
+        return;
+    if (len_ + n > sizeof(buf_)) {
+        flush();
+        if (n > sizeof(buf_)) {
+            out_.write(str, n);
+            return;
+        }
+    }
+    memcpy(buf_ + len_, str, n);
+    len_ += n;
+}
+
+void
+Value_Printer::flush()
+{
+    if (len_ > 0) {
+        out_.write(buf_, len_);
+        len_ = 0;
+    }
+}
+
+// Integers are by far the most common numbers in generated data, so they
+// are converted without calling the shortest-float algorithm in dtostr.
+// The output is the same: dtostr switches to exponential format when an
+// integer has more than 3 trailing zeros, so those take the slow path.
+void
+Value_Printer::put_num(double n)
+{
+    if (n == std::floor(n) && std::abs(n) < 1e15 && !(n == 0 && std::signbit(n)))
+    {
+        char digits[20];
+        char* p = digits + sizeof(digits);
+        uint64_t u = uint64_t(std::abs(n));
+        int trailing_zeros = 0;
+        bool nonzero_seen = false;
+        do {
+            unsigned d = unsigned(u % 10);
+            if (d != 0) nonzero_seen = true;
+            else if (!nonzero_seen) ++trailing_zeros;
+            *--p = char('0' + d);
+            u /= 10;
+        } while (u != 0);
+        if (n == 0 || trailing_zeros <= 3) {
+            if (n < 0) *--p = '-';
+            put(p, digits + sizeof(digits) - p);
+            return;
+        }
+    }
+    char buf[DTOSTR_BUFSIZE];
+    dtostr(n, buf);
+    put(buf, strlen(buf));
+}
+
+void
+Value_Printer::print(Value val)
+{
+    if (truncated_)
+        return;
+    if (val.is_num()) {
+        put_num(val.get_num_unsafe());
+    } else if (val.is_null()) {
+        put("null", 4);
+    } else if (val.is_bool()) {
+        if (val.get_bool_unsafe())
+            put("true", 4);
+        else
+            put("false", 5);
+    } else if (val.is_ref()) {
+        Ref_Value& r = val.get_ref_unsafe();
+        switch (r.type_) {
+        case Ref_Value::ty_string:
+            print((const String&)r);
+            break;
+        case Ref_Value::ty_list:
+            print((const List_Base&)r);
+            break;
+        case Ref_Value::ty_record:
+            print((const Record&)r);
+            break;
+        case Ref_Value::ty_module:
+            print((const Module_Base&)r);
+            break;
+        default:
+            flush();
+            r.print(out_);
+        }
+    } else if (val.is_inline_string()) {
+        char buf[Value::k_max_inline_string+1];
+        val.get_inline_string(buf);
+        put_string(buf, val.inline_string_size());
+    } else {
+        put("???", 3);
+    }
+}
+
+void
+Value_Printer::print(const String& str)
+{
+    put_string(str.data(), str.size());
+}
+
+void
+Value_Printer::put_string(const char* p, size_t n)
+{
+    put('"');
+    const char* end = p + n;
+    while (p < end && !truncated_) {
+        // Copy runs of characters that don't need escaping in one step.
+        const char* run = p;
+        while (p < end && *p != '$' && *p != '"')
+            ++p;
+        put(run, p - run);
+        if (p < end) {
+            char esc[2] = {*p, *p};
+            put(esc, 2);
+            ++p;
+        }
+    }
+    put('"');
+}
+
+void
+Value_Printer::print(const List_Base& list)
+{
+    put('[');
+    for (size_t i = 0; i < list.size() && !truncated_; ++i) {
+        if (i > 0) put(',');
+        print(list[i]);
+    }
+    put(']');
+}
+
+void
+Value_Printer::put_field(Atom name, Value val)
+{
+    put(name.data(), name.size());
+    put(':');
+    print(val);
+}
+
+void
+Value_Printer::print(const Record& rec)
+{
+    put('{');
+    bool first = true;
+    for (auto& i : rec.fields_) {
+        if (truncated_) break;
+        if (!first) put(',');
+        first = false;
+        put_field(i.first, i.second);
+    }
+    put('}');
+}
+
+void
+Value_Printer::print(const Module_Base& m)
+{
+    put('{');
+    bool first = true;
+    for (auto i : m) {
+        if (truncated_) break;
+        if (!first) put(',');
+        first = false;
+        put_field(i.first, i.second);
+    }
+    put('}');
+}
+
+} // namespace curv
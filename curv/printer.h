@@ -0,0 +1,68 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef CURV_PRINTER_H
+#define CURV_PRINTER_H
+
+#include <ostream>
+#include <curv/value.h>
+
+namespace curv {
+
+struct String;
+struct List_Base;
+struct Record;
+struct Module_Base;
+
+/// Print Values as Curv expressions, through a private buffer.
+///
+/// Numbers, strings, lists, records and modules are formatted directly
+/// into the buffer, without a virtual call or an ostream insertion per
+/// element. Other values fall back to Ref_Value::print.
+///
+/// If `limit` is nonzero, printing stops after `limit` characters, and the
+/// output ends with "...". The REPL uses this to preview huge values.
+struct Value_Printer
+{
+    Value_Printer(std::ostream& out, size_t limit = 0)
+    :
+        out_(out),
+        limit_(limit)
+    {}
+    ~Value_Printer() { flush(); }
+
+    void print(Value);
+    void print(const String&);
+    void print(const List_Base&);
+    void print(const Record&);
+    void print(const Module_Base&);
+    void flush();
+
+    /// True if output was cut short by the limit.
+    bool truncated() const { return truncated_; }
+
+private:
+    std::ostream& out_;
+    size_t limit_;
+    size_t count_ = 0;
+    bool truncated_ = false;
+    size_t len_ = 0;
+    char buf_[4096];
+
+    bool room(size_t n);
+    void put(char c)
+    {
+        if (room(1)) {
+            if (len_ == sizeof(buf_)) flush();
+            buf_[len_++] = c;
+        }
+    }
+    void put(const char*, size_t);
+    void put_num(double);
+    void put_string(const char*, size_t);
+    void put_field(Atom, Value);
+};
+
+} // namespace curv
+#endif // header guard
@@ -3,6 +3,7 @@
 // See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
 
 #include <curv/record.h>
+#include <curv/printer.h>
 
 namespace curv {
 
@@ -11,15 +12,7 @@ const char Record::name[] = "record";
 void
 Record::print(std::ostream& out) const
 {
-    out << "{";
-    bool first = true;
-    for (auto i : fields_) {
-        if (!first) out << ",";
-        first = false;
-        out << i.first << ":";
-        i.second.print(out);
-    }
-    out << "}";
+    Value_Printer(out).print(*this);
 }
 
 void
@@ -56,6 +49,15 @@ Record::getfield(Atom name, const Context& cx) const
     return Structure::getfield(name, cx);
 }
 
+Value
+Record::getfield(const char* name, const Context& cx) const
+{
+    auto fp = fields_.find(name);
+    if (fp != fields_.end())
+        return fp->second;
+    return Structure::getfield(Atom(name), cx);
+}
+
 bool
 Record::hasfield(Atom name) const
 {
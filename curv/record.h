@@ -22,6 +22,7 @@ struct Record : public Structure
         fields_(std::move(fields))
     {
     }
+    static bool has_type(uint32_t ty) { return ty == ty_record; }
 
     Shared<const Record> clone() const
     {
@@ -32,6 +33,7 @@ struct Record : public Structure
     virtual void print(std::ostream&) const override;
     bool operator==(const Record&) const;
     virtual Value getfield(Atom, const Context&) const override;
+    virtual Value getfield(const char*, const Context&) const override;
     virtual bool hasfield(Atom) const override;
     virtual void putfields(Atom_Map<Value>&) const override;
     virtual Shared<List> fields() const override;
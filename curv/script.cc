@@ -0,0 +1,37 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#include <algorithm>
+#include <curv/script.h>
+
+namespace curv {
+
+const std::vector<uint32_t>&
+Script::line_begins() const
+{
+    std::call_once(line_begins_once_, [this]() {
+        line_begins_.push_back(0);
+        for (uint32_t j = 0; j < size(); ++j) {
+            if ((*this)[j] == '\n')
+                line_begins_.push_back(j+1);
+        }
+    });
+    return line_begins_;
+}
+
+unsigned
+Script::line_num(uint32_t i) const
+{
+    auto& lines = line_begins();
+    auto p = std::upper_bound(lines.begin(), lines.end(), i);
+    return unsigned(p - lines.begin()) - 1;
+}
+
+uint32_t
+Script::line_begin(unsigned lineno) const
+{
+    return line_begins()[lineno];
+}
+
+} // namespace curv
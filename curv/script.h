@@ -8,6 +8,8 @@
 #include <curv/range.h>
 #include <curv/shared.h>
 #include <curv/string.h>
+#include <mutex>
+#include <vector>
 
 namespace curv {
 
@@ -33,6 +35,20 @@ protected:
     {}
 public:
     virtual ~Script() {}
+
+    /// Return the 0-based number of the line containing byte index `i`.
+    /// A byte index that follows a newline belongs to the next line.
+    /// The line index is built on first use, so lookups are O(log n).
+    /// This is thread safe: definitions may be evaluated in parallel.
+    unsigned line_num(uint32_t i) const;
+
+    /// Byte index of the first character of a line.
+    uint32_t line_begin(unsigned lineno) const;
+private:
+    // Byte index of the start of each line, built on first use.
+    mutable std::once_flag line_begins_once_;
+    mutable std::vector<uint32_t> line_begins_;
+    const std::vector<uint32_t>& line_begins() const;
 };
 
 /// A concrete Script subclass where the contents are represented as a String.
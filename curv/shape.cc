@@ -16,24 +16,24 @@ namespace curv {
 BBox
 BBox::from_value(Value val, const Context& cx)
 {
-    auto list = val.to<List>(cx);
-    list->assert_size(2, cx);
+    auto& list = val.to_ref<const List>(cx);
+    list.assert_size(2, cx);
 
     At_Index mincx(0, cx);
-    auto mins = list->at(0).to<List>(mincx);
-    mins->assert_size(3, mincx);
+    auto& mins = list.at(0).to_ref<const List>(mincx);
+    mins.assert_size(3, mincx);
 
     At_Index maxcx(1, cx);
-    auto maxs = list->at(1).to<List>(maxcx);
-    maxs->assert_size(3, maxcx);
+    auto& maxs = list.at(1).to_ref<const List>(maxcx);
+    maxs.assert_size(3, maxcx);
 
     BBox b;
-    b.xmin = mins->at(0).to_num(cx);
-    b.ymin = mins->at(1).to_num(cx);
-    b.zmin = mins->at(2).to_num(cx);
-    b.xmax = maxs->at(0).to_num(cx);
-    b.ymax = maxs->at(1).to_num(cx);
-    b.zmax = maxs->at(2).to_num(cx);
+    b.xmin = mins.at(0).to_num(cx);
+    b.ymin = mins.at(1).to_num(cx);
+    b.zmin = mins.at(2).to_num(cx);
+    b.xmax = maxs.at(0).to_num(cx);
+    b.ymax = maxs.at(1).to_num(cx);
+    b.zmax = maxs.at(2).to_num(cx);
     return b;
 }
 
@@ -52,7 +52,7 @@ Shape_Recognizer::recognize(Value val)
     Value dist_val;
     Value colour_val;
 
-    auto s = val.dycast<Structure>();
+    auto s = val.dycast_ptr<const Structure>();
     if (s == nullptr)
         return false;
     if (s->hasfield(is_2d_key))
@@ -145,11 +145,11 @@ Shape_Recognizer::colour(double x, double y, double z, double t)
     auto frame = Frame::make(
         colour_->nslots_, system_, nullptr, nullptr, nullptr);
     Value result = colour_->call({point}, *frame);
-    Shared<List> cval = result.to<List>(context_);
-    cval->assert_size(3, context_);
-    return Vec3{ cval->at(0).to_num(context_),
-                 cval->at(1).to_num(context_),
-                 cval->at(2).to_num(context_) };
+    auto& cval = result.to_ref<const List>(context_);
+    cval.assert_size(3, context_);
+    return Vec3{ cval.at(0).to_num(context_),
+                 cval.at(1).to_num(context_),
+                 cval.at(2).to_num(context_) };
 }
 
 } // namespace curv
@@ -0,0 +1,12 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#include <curv/shared.h>
+
+namespace curv {
+
+std::atomic<std::uint64_t> shared_alloc_count{0};
+std::atomic<unsigned> atomic_refcount_scopes{0};
+
+} // namespace curv
@@ -6,10 +6,12 @@
 #define CURV_SHARED_H
 
 #include <boost/intrusive_ptr.hpp>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <new>
+#include <curv/budget.h>
 
 namespace curv {
 
@@ -49,6 +51,7 @@ struct Shared : public boost::intrusive_ptr<T>
 /// Cheap alternative to `std::make_shared`.
 template<typename T, class... Args> Shared<T> make(Args&&... args)
 {
+    budget_alloc(sizeof(T));
     void* raw = std::malloc(sizeof(T));
     if (raw == nullptr)
         throw std::bad_alloc();
@@ -62,11 +65,18 @@ template<typename T, class... Args> Shared<T> make(Args&&... args)
     return Shared<T>(ptr);
 }
 
+/// The number of Shared_Base objects constructed, by all threads.
+/// This is an allocation statistic, reported by the REPL's `:time` command.
+/// It is only a count, so relaxed increments are enough.
+extern std::atomic<std::uint64_t> shared_alloc_count;
+
 /// Common base class for cheap reference-counted objects.
 ///
 /// For performance reasons, the use_count is incremented and decremented
 /// non-atomically, which is not thread safe. That's what you typically
 /// need in cases where `std::shared_ptr` is too expensive.
+/// While worker threads share Curv values (see Atomic_Refcount_Scope),
+/// the updates are atomic instead.
 ///
 /// The memory overhead is one use_count, instead of two for `std::shared_ptr`.
 /// Plus I'm forcing the use of a vtable. I specifically want the vtable pointer
@@ -114,7 +124,10 @@ template<typename T, class... Args> Shared<T> make(Args&&... args)
 ///      `share()` aborts if use_count==0.
 struct Shared_Base
 {
-    Shared_Base() : use_count(0) {}
+    Shared_Base() : use_count(0)
+    {
+        shared_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    }
     virtual ~Shared_Base() {}
     mutable std::uint32_t use_count;
 
@@ -124,6 +137,7 @@ struct Shared_Base
     // consistently use free for freeing Shared_Base objects.
     void* operator new(std::size_t size)
     {
+        budget_alloc(size);
         void* p = malloc(size);
         if (p == nullptr)
             throw std::bad_alloc();
@@ -143,25 +157,42 @@ private:
     Shared_Base& operator=(const Shared_Base&) = delete;
 };
 
+/// The number of active Atomic_Refcount_Scopes. While this is nonzero,
+/// use_count updates are atomic read-modify-write operations (using the
+/// GCC/Clang __atomic builtins, since use_count is a plain integer).
+/// Otherwise, they are ordinary increments and decrements.
+extern std::atomic<unsigned> atomic_refcount_scopes;
+
+/// Make reference counting thread safe for the lifetime of this object.
+/// Construct it before starting worker threads that share Curv values,
+/// and destroy it after they have been joined.
+struct Atomic_Refcount_Scope
+{
+    Atomic_Refcount_Scope() { ++atomic_refcount_scopes; }
+    ~Atomic_Refcount_Scope() { --atomic_refcount_scopes; }
+    Atomic_Refcount_Scope(const Atomic_Refcount_Scope&) = delete;
+    Atomic_Refcount_Scope& operator=(const Atomic_Refcount_Scope&) = delete;
+};
+
 inline void intrusive_ptr_add_ref(const Shared_Base* p)
 {
-    ++p->use_count;
+    if (atomic_refcount_scopes.load(std::memory_order_relaxed) != 0)
+        __atomic_fetch_add(&p->use_count, 1, __ATOMIC_RELAXED);
+    else
+        ++p->use_count;
 }
 
 inline void intrusive_ptr_release(const Shared_Base* p)
 {
-    if (--p->use_count == 0)
+    std::uint32_t n;
+    if (atomic_refcount_scopes.load(std::memory_order_relaxed) != 0)
+        n = __atomic_sub_fetch(&p->use_count, 1, __ATOMIC_ACQ_REL);
+    else
+        n = --p->use_count;
+    if (n == 0)
         delete p;
 }
 
-// How to support atomic refcount update in the future.
-// * Add a Shared_Atomic_Base class, which always uses atomic updates.
-// * Add a Shared_Maybe_Atomic_Base class, which reserves a bit in the
-//   use_count to indicate whether the use_count should be updated atomically.
-//   When an object is first constructed, it's only accessible from one thread.
-//   Later, it might "escape" and become visible to more than thread.
-//   If and when this happens, we mark the object as atomic.
-
 template<class T, class U>
 inline Shared<T>
 cast(Shared<U> p)
@@ -0,0 +1,222 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#include <curv/stream.h>
+#include <curv/arg.h>
+#include <curv/context.h>
+#include <curv/exception.h>
+#include <curv/frame.h>
+
+namespace curv {
+
+const char Stream::name[] = "stream";
+
+void
+Stream::print(std::ostream& out) const
+{
+    out << "<stream>";
+}
+
+Value
+Stream::at(size_t i, Frame& f, const Context& cx) const
+{
+    auto cur = cursor();
+    Value val;
+    for (size_t j = 0; j <= i; ++j) {
+        if (!cur->next(val, f))
+            throw Exception(cx, stringify("index ",i," is out of range"));
+    }
+    return val;
+}
+
+Value
+call_function(Function& fun, Value arg, Frame& f)
+{
+    std::unique_ptr<Frame> f2 {
+        Frame::make(fun.nslots_, f.system_, &f, f.call_phrase_, nullptr)
+    };
+    return fun.call(arg, *f2);
+}
+
+struct List_Cursor : public Stream::Cursor
+{
+    Shared<const List> list_;
+    size_t i_ = 0;
+
+    List_Cursor(Shared<const List> list) : list_(std::move(list)) {}
+    virtual bool next(Value& val, Frame&) override
+    {
+        if (i_ == list_->size())
+            return false;
+        val = (*list_)[i_++];
+        return true;
+    }
+};
+
+std::unique_ptr<Stream::Cursor>
+make_cursor(Value val, const Context& cx)
+{
+    if (auto stream = val.dycast_ptr<const Stream>())
+        return stream->cursor();
+    if (auto list = val.dycast<const List>())
+        return std::unique_ptr<Stream::Cursor>(new List_Cursor(list));
+    throw Exception(cx, "not a list or stream");
+}
+
+struct Unfold_Cursor : public Stream::Cursor
+{
+    const Unfold_Stream& stream_;
+    Value state_;
+
+    Unfold_Cursor(const Unfold_Stream& s) : stream_(s), state_(s.seed_) {}
+    virtual bool next(Value& val, Frame& f) override
+    {
+        Value r = call_function(*stream_.step_, state_, f);
+        if (r.is_null())
+            return false;
+        auto pair = r.dycast_ptr<const List>();
+        if (pair == nullptr || pair->size() != 2)
+            throw Exception(At_Frame(&f), stringify(
+                "unfold: step function returned ",r,
+                ", expected null or [element, next_state]"));
+        val = (*pair)[0];
+        state_ = (*pair)[1];
+        return true;
+    }
+};
+
+std::unique_ptr<Stream::Cursor>
+Unfold_Stream::cursor() const
+{
+    return std::unique_ptr<Cursor>(new Unfold_Cursor(*this));
+}
+
+struct Map_Cursor : public Stream::Cursor
+{
+    const Map_Stream& stream_;
+    std::unique_ptr<Stream::Cursor> source_;
+
+    Map_Cursor(const Map_Stream& s)
+    :
+        stream_(s),
+        source_(make_cursor(s.source_, {}))
+    {}
+    virtual bool next(Value& val, Frame& f) override
+    {
+        Value x;
+        if (!source_->next(x, f))
+            return false;
+        val = call_function(*stream_.fun_, x, f);
+        return true;
+    }
+};
+
+std::unique_ptr<Stream::Cursor>
+Map_Stream::cursor() const
+{
+    return std::unique_ptr<Cursor>(new Map_Cursor(*this));
+}
+
+struct Filter_Cursor : public Stream::Cursor
+{
+    const Filter_Stream& stream_;
+    std::unique_ptr<Stream::Cursor> source_;
+
+    Filter_Cursor(const Filter_Stream& s)
+    :
+        stream_(s),
+        source_(make_cursor(s.source_, {}))
+    {}
+    virtual bool next(Value& val, Frame& f) override
+    {
+        while (source_->next(val, f)) {
+            Value keep = call_function(*stream_.pred_, val, f);
+            if (keep.to_bool(At_Frame(&f)))
+                return true;
+        }
+        return false;
+    }
+};
+
+std::unique_ptr<Stream::Cursor>
+Filter_Stream::cursor() const
+{
+    return std::unique_ptr<Cursor>(new Filter_Cursor(*this));
+}
+
+struct Take_Cursor : public Stream::Cursor
+{
+    size_t remaining_;
+    std::unique_ptr<Stream::Cursor> source_;
+
+    Take_Cursor(const Take_Stream& s)
+    :
+        remaining_(s.count_),
+        source_(make_cursor(s.source_, {}))
+    {}
+    virtual bool next(Value& val, Frame& f) override
+    {
+        if (remaining_ == 0)
+            return false;
+        --remaining_;
+        return source_->next(val, f);
+    }
+};
+
+std::unique_ptr<Stream::Cursor>
+Take_Stream::cursor() const
+{
+    return std::unique_ptr<Cursor>(new Take_Cursor(*this));
+}
+
+bool
+Memo_Stream::fill(size_t i, Frame& f) const
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (source_cursor_ == nullptr && !done_)
+        source_cursor_ = make_cursor(source_, At_Frame(&f));
+    while (cache_.size() <= i && !done_) {
+        Value val;
+        if (source_cursor_->next(val, f))
+            cache_.push_back(val);
+        else {
+            done_ = true;
+            source_cursor_ = nullptr;
+        }
+    }
+    return i < cache_.size();
+}
+
+struct Memo_Cursor : public Stream::Cursor
+{
+    const Memo_Stream& stream_;
+    size_t i_ = 0;
+
+    Memo_Cursor(const Memo_Stream& s) : stream_(s) {}
+    virtual bool next(Value& val, Frame& f) override
+    {
+        if (!stream_.fill(i_, f))
+            return false;
+        std::lock_guard<std::recursive_mutex> lock(stream_.mutex_);
+        val = stream_.cache_[i_++];
+        return true;
+    }
+};
+
+std::unique_ptr<Stream::Cursor>
+Memo_Stream::cursor() const
+{
+    return std::unique_ptr<Cursor>(new Memo_Cursor(*this));
+}
+
+Value
+Memo_Stream::at(size_t i, Frame& f, const Context& cx) const
+{
+    if (!fill(i, f))
+        throw Exception(cx, stringify("index ",i," is out of range"));
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return cache_[i];
+}
+
+} // namespace curv
@@ -0,0 +1,139 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef CURV_STREAM_H
+#define CURV_STREAM_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <curv/frame.h>
+#include <curv/function.h>
+#include <curv/value.h>
+
+namespace curv {
+
+struct Context;
+
+/// A lazy sequence of values.
+///
+/// The elements of a Stream are computed on demand, by pulling them one at
+/// a time through a Cursor, so a pipeline over a huge or unbounded sequence
+/// runs in constant memory. A Stream is immutable: each iteration creates
+/// a new Cursor, and recomputes the elements, unless the stream is memoized
+/// (see Memo_Stream).
+///
+/// Streams are consumed by `for` loops and list comprehensions, `count`,
+/// and indexing. A list comprehension materializes a stream as a List.
+struct Stream : public Ref_Value
+{
+    Stream() : Ref_Value(ty_stream) {}
+
+    static bool has_type(uint32_t ty) { return ty == ty_stream; }
+    static const char name[];
+
+    struct Cursor
+    {
+        virtual ~Cursor() {}
+
+        /// Store the next element in `val` and return true, or return false
+        /// at the end of the stream. Curv functions are called in a child
+        /// frame of `f`.
+        virtual bool next(Value& val, Frame& f) = 0;
+    };
+    virtual std::unique_ptr<Cursor> cursor() const = 0;
+
+    /// Return element i. This takes O(i) time, unless the stream is memoized.
+    virtual Value at(size_t i, Frame& f, const Context&) const;
+
+    virtual void print(std::ostream&) const override;
+};
+
+/// Return a Cursor for the elements of a List or Stream.
+/// Throws an exception if `val` is neither.
+std::unique_ptr<Stream::Cursor> make_cursor(Value val, const Context&);
+
+/// Call a function value with one argument, in a child frame of `f`.
+Value call_function(Function&, Value arg, Frame& f);
+
+/// A stream generated from an initial state, seed_. Each call of step_ on
+/// a state returns either null (the end), or [element, next_state].
+struct Unfold_Stream : public Stream
+{
+    Value seed_;
+    Shared<Function> step_;
+
+    Unfold_Stream(Value seed, Shared<Function> step)
+    :
+        seed_(std::move(seed)),
+        step_(std::move(step))
+    {}
+    virtual std::unique_ptr<Cursor> cursor() const override;
+};
+
+/// Apply fun_ to each element of source_ (a List or Stream).
+struct Map_Stream : public Stream
+{
+    Shared<Function> fun_;
+    Value source_;
+
+    Map_Stream(Shared<Function> fun, Value source)
+    :
+        fun_(std::move(fun)),
+        source_(std::move(source))
+    {}
+    virtual std::unique_ptr<Cursor> cursor() const override;
+};
+
+/// The elements of source_ for which pred_ returns true.
+struct Filter_Stream : public Stream
+{
+    Shared<Function> pred_;
+    Value source_;
+
+    Filter_Stream(Shared<Function> pred, Value source)
+    :
+        pred_(std::move(pred)),
+        source_(std::move(source))
+    {}
+    virtual std::unique_ptr<Cursor> cursor() const override;
+};
+
+/// The first count_ elements of source_.
+struct Take_Stream : public Stream
+{
+    size_t count_;
+    Value source_;
+
+    Take_Stream(size_t count, Value source)
+    :
+        count_(count),
+        source_(std::move(source))
+    {}
+    virtual std::unique_ptr<Cursor> cursor() const override;
+};
+
+/// A stream that remembers the elements of source_ as they are computed,
+/// so that repeated iteration and indexing don't recompute them.
+/// The cache is shared by all cursors, and guarded by a mutex.
+struct Memo_Stream : public Stream
+{
+    Value source_;
+
+    Memo_Stream(Value source) : source_(std::move(source)) {}
+    virtual std::unique_ptr<Cursor> cursor() const override;
+    virtual Value at(size_t i, Frame& f, const Context&) const override;
+
+    /// Make sure that element i is cached, if the stream is long enough.
+    /// Return false if the stream has fewer than i+1 elements.
+    bool fill(size_t i, Frame& f) const;
+
+    mutable std::recursive_mutex mutex_;
+    mutable std::vector<Value> cache_;
+    mutable std::unique_ptr<Cursor> source_cursor_;
+    mutable bool done_ = false;
+};
+
+} // namespace curv
+#endif // header guard
@@ -3,6 +3,7 @@
 // See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
 
 #include <curv/string.h>
+#include <curv/printer.h>
 
 namespace curv {
 
@@ -28,17 +29,26 @@ String_Builder::get_string()
     return String::make(s.data(), s.size()); // copies the data again
 }
 
+Value
+String_Builder::get_value()
+{
+    auto s = str();
+    return make_string_value(s.data(), s.size());
+}
+
+String_Ref
+value_to_string(const Value& val, const Context& cx)
+{
+    String_Ref str(val);
+    if (!str)
+        Value::to_abort(cx, String::name);
+    return str;
+}
+
 void
 String::print(std::ostream& out) const
 {
-    out << '"';
-    for (size_t i = 0; i < size_; ++i) {
-        char c = data_[i];
-        if (c == '$' || c == '"')
-            out << c;
-        out << c;
-    }
-    out << '"';
+    Value_Printer(out).print(*this);
 }
 
 } // namespace curv
@@ -31,6 +31,8 @@ private:
     size_t size_;
     char data_[1];
 public:
+    static bool has_type(uint32_t ty) { return ty == ty_string; }
+
     /// Make a curv::String from an array of characters
     static Shared<String> make(const char*, size_t);
     inline static Shared<String> make(Range<const char*> r)
@@ -84,6 +86,74 @@ make_string(const char*str)
     return String::make(str, strlen(str));
 }
 
+/// Make a string Value from an array of characters.
+/// Short strings are stored inline in the Value (see Value::inline_string),
+/// longer strings are allocated as a curv::String.
+inline Value make_string_value(const char* str, size_t len)
+{
+    if (len <= Value::k_max_inline_string)
+        return Value::inline_string(str, len);
+    return {String::make(str, len)};
+}
+
+/// A view of the characters of a string Value, which is either a String
+/// reference value, or a short string stored inline in the Value.
+///
+/// Test for a string using `if (auto str = String_Ref(val))`.
+/// Like dycast_ptr, the view of a String is borrowed, and becomes invalid
+/// if the original Value is destroyed. Use `shared()` to keep the string.
+struct String_Ref
+{
+    explicit String_Ref(const Value& val) noexcept
+    {
+        if (val.is_inline_string()) {
+            size_ = val.inline_string_size();
+            val.get_inline_string(buf_);
+        } else if ((heap_ = val.dycast_ptr<const String>()) != nullptr) {
+            size_ = heap_->size();
+        }
+    }
+
+    explicit operator bool() const noexcept { return size_ != npos; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char* data() const { return heap_ ? heap_->data() : buf_; }
+    const char* c_str() const { return data(); }
+    const char* begin() const { return data(); }
+    const char* end() const { return data() + size_; }
+    char operator[](size_t i) const { return data()[i]; }
+    bool operator==(const String_Ref& s) const
+    {
+        return size_ == s.size_ && memcmp(data(), s.data(), size_) == 0;
+    }
+    bool operator!=(const String_Ref& s) const { return !(*this == s); }
+
+    /// Return the string as a curv::String, allocating one for an
+    /// inline string.
+    Shared<const String> shared() const
+    {
+        if (heap_) return share(*heap_);
+        return String::make(buf_, size_);
+    }
+
+private:
+    static constexpr size_t npos = size_t(-1);
+    const String* heap_ = nullptr;
+    size_t size_ = npos;
+    char buf_[Value::k_max_inline_string+1];
+};
+
+inline std::ostream&
+operator<<(std::ostream& out, const String_Ref& str)
+{
+    out.write(str.data(), str.size());
+    return out;
+}
+
+/// Convert a Value to a String_Ref, throw an exception if wrong type.
+String_Ref value_to_string(const Value&, const Context&);
+
 /// Factory class for building a curv::String using ostream operations.
 struct String_Builder : public std::stringstream
 {
@@ -92,6 +162,9 @@ struct String_Builder : public std::stringstream
 
     Shared<String> get_string();
 
+    /// Like get_string, but short strings are stored inline in the Value.
+    Value get_value();
+
     // variadic function that appends each argument to the string buffer
     template<typename First, typename... Rest>
     void write_all(First first, Rest... rest)
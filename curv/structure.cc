@@ -15,4 +15,10 @@ Structure::getfield(Atom field, const Context& cx) const
     throw Exception(cx, stringify(".",field,": not defined"));
 }
 
+Value
+Structure::getfield(const char* field, const Context& cx) const
+{
+    return getfield(Atom(field), cx);
+}
+
 } // namespace curv
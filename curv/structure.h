@@ -17,10 +17,17 @@ namespace curv {
 struct Structure : public Ref_Value
 {
     Structure(int type) : Ref_Value(type) {}
+    static bool has_type(uint32_t ty)
+    {
+        return ty == ty_record || ty == ty_module;
+    }
 
     /// Get the value of a named field, throw exception if not defined.
     virtual Value getfield(Atom, const Context&) const;
 
+    /// Same, but the name is a C string, which need not be copied to an Atom.
+    virtual Value getfield(const char*, const Context&) const;
+
     /// Test if the value contains the named field.
     virtual bool hasfield(Atom) const = 0;
 
@@ -2,9 +2,12 @@
 // Licensed under the Apache License, version 2.0
 // See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
 
+#include <dlfcn.h>
 #include <curv/context.h>
+#include <curv/exception.h>
 #include <curv/program.h>
 #include <curv/file.h>
+#include <curv/plugin.h>
 #include <curv/system.h>
 
 namespace curv {
@@ -27,6 +30,21 @@ void System_Impl::load_library(Shared<const String> path)
         std_namespace_[b.first] = make<Builtin_Value>(b.second);
 }
 
+void System_Impl::load_plugin(Shared<const String> path)
+{
+    // The library is never unloaded: the std namespace holds values
+    // whose code lives in the library.
+    void* lib = dlopen(path->c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (lib == nullptr)
+        throw Exception(Context{}, stringify("can't load plugin: ", dlerror()));
+    auto init = (Plugin_Init_Function) dlsym(lib, "curv_plugin_init");
+    if (init == nullptr) {
+        throw Exception(Context{}, stringify("plugin ",path,
+            " has no curv_plugin_init entry point"));
+    }
+    init(std_namespace_);
+}
+
 const Namespace& System_Impl::std_namespace()
 {
     return std_namespace_;
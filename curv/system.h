@@ -30,6 +30,10 @@ struct System_Impl : public System
     std::ostream& console_;
     System_Impl(std::ostream&);
     void load_library(Shared<const String> path);
+
+    /// Load a native plugin (a shared library) and add its bindings
+    /// to the std namespace. See <curv/plugin.h>.
+    void load_plugin(Shared<const String> path);
     virtual const Namespace& std_namespace() override;
     virtual std::ostream& console() override;
 };
@@ -11,6 +11,7 @@
 #include <new>
 #include <utility>
 #include <memory>
+#include <curv/budget.h>
 
 namespace curv {
 
@@ -112,6 +113,7 @@ public:
     static std::unique_ptr<Tail_Array> make(size_t size, Rest&&... rest)
     {
         // allocate the object
+        budget_alloc(sizeof(Tail_Array) + size*sizeof(_value_type));
         void* mem = malloc(sizeof(Tail_Array) + size*sizeof(_value_type));
         if (mem == nullptr)
             throw std::bad_alloc();
@@ -146,6 +148,7 @@ public:
     {
         // allocate the object
         auto size = c.size();
+        budget_alloc(sizeof(Tail_Array) + size*sizeof(_value_type));
         void* mem = malloc(sizeof(Tail_Array) + size*sizeof(_value_type));
         if (mem == nullptr)
             throw std::bad_alloc();
@@ -184,6 +187,7 @@ public:
     static std::unique_ptr<Tail_Array> make_copy(_value_type* a, size_t size, Rest&&... rest)
     {
         // allocate the object
+        budget_alloc(sizeof(Tail_Array) + size*sizeof(_value_type));
         void* mem = malloc(sizeof(Tail_Array) + size*sizeof(_value_type));
         if (mem == nullptr)
             throw std::bad_alloc();
@@ -230,6 +234,7 @@ public:
     {
         // TODO: much code duplication here.
         // allocate the object
+        budget_alloc(sizeof(Tail_Array) + il.size()*sizeof(_value_type));
         void* mem = malloc(sizeof(Tail_Array) + il.size()*sizeof(_value_type));
         if (mem == nullptr)
             throw std::bad_alloc();
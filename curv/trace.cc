@@ -0,0 +1,92 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <curv/trace.h>
+
+namespace curv {
+
+bool trace_enabled = false;
+
+namespace {
+
+struct Trace_Event
+{
+    const char* name;
+    Trace_Clock::time_point start;
+    Trace_Clock::time_point end;
+};
+
+struct Thread_Trace
+{
+    unsigned tid;
+    std::vector<Trace_Event> events;
+};
+
+Trace_Clock::time_point trace_epoch;
+
+// Thread buffers are owned by this list, so they outlive their threads.
+std::mutex trace_mutex;
+std::vector<std::unique_ptr<Thread_Trace>> trace_threads;
+thread_local Thread_Trace* this_thread_trace = nullptr;
+
+Thread_Trace& thread_trace()
+{
+    if (this_thread_trace == nullptr) {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        trace_threads.emplace_back(
+            new Thread_Trace{unsigned(trace_threads.size()), {}});
+        this_thread_trace = trace_threads.back().get();
+    }
+    return *this_thread_trace;
+}
+
+double micros(Trace_Clock::duration d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+} // namespace
+
+void trace_start()
+{
+    trace_epoch = Trace_Clock::now();
+    trace_enabled = true;
+}
+
+void trace_event(const char* name, Trace_Clock::time_point start,
+    Trace_Clock::time_point end)
+{
+    thread_trace().events.push_back({name, start, end});
+}
+
+void trace_write(std::ostream& out)
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    // Times are microseconds, to the nanosecond. The default precision of
+    // 6 digits would round timestamps after 10 seconds, and use exponents.
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (auto& t : trace_threads) {
+        for (auto& e : t->events) {
+            if (!first) out << ",";
+            first = false;
+            out << "\n{\"name\":\"" << e.name << "\",\"ph\":\"X\""
+                << ",\"ts\":" << micros(e.start - trace_epoch)
+                << ",\"dur\":" << micros(e.end - e.start)
+                << ",\"pid\":1,\"tid\":" << t->tid << "}";
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // namespace curv
@@ -0,0 +1,57 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef CURV_TRACE_H
+#define CURV_TRACE_H
+
+#include <chrono>
+#include <ostream>
+
+namespace curv {
+
+/// Timeline tracing, in the Chrome trace event format
+/// (load the output into chrome://tracing or https://ui.perfetto.dev).
+///
+/// Each thread records events into its own buffer, without locking.
+/// A mutex is only taken the first time a thread records an event.
+/// Tracing is enabled once at startup, before any worker threads exist;
+/// when it is disabled, a Trace_Scope costs one test of a global flag.
+extern bool trace_enabled;
+
+/// Enable tracing. Timestamps are relative to this call.
+void trace_start();
+
+/// Write all recorded events as a JSON trace. Call this after worker
+/// threads have finished recording.
+void trace_write(std::ostream&);
+
+using Trace_Clock = std::chrono::steady_clock;
+
+/// Record a complete event on the current thread's timeline.
+/// `name` must be a string literal, or otherwise outlive the trace.
+void trace_event(const char* name, Trace_Clock::time_point start,
+    Trace_Clock::time_point end);
+
+/// Record the lifetime of this object as a named event.
+struct Trace_Scope
+{
+    const char* name_;
+    Trace_Clock::time_point start_;
+
+    explicit Trace_Scope(const char* name)
+    :
+        name_(trace_enabled ? name : nullptr)
+    {
+        if (name_) start_ = Trace_Clock::now();
+    }
+    ~Trace_Scope()
+    {
+        if (name_) trace_event(name_, start_, Trace_Clock::now());
+    }
+    Trace_Scope(const Trace_Scope&) = delete;
+    Trace_Scope& operator=(const Trace_Scope&) = delete;
+};
+
+} // namespace curv
+#endif // header guard
@@ -3,11 +3,11 @@
 // See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
 
 #include <curv/value.h>
-#include <curv/dtostr.h>
 #include <curv/string.h>
 #include <curv/list.h>
 #include <curv/record.h>
 #include <curv/exception.h>
+#include <curv/printer.h>
 
 namespace curv {
 
@@ -40,11 +40,8 @@ Value::to_abort [[noreturn]] (const Context& cx, const char* type)
 Value
 Value::at(Atom field, const Context& cx) const
 {
-    if (is_ref()) {
-        Structure* s = dynamic_cast<Structure*>(&get_ref_unsafe());
-        if (s)
-            return s->getfield(field, cx);
-    }
+    if (auto s = dycast_ptr<const Structure>())
+        return s->getfield(field, cx);
     throw Exception(cx, stringify(".",field,": not defined"));
 }
 
@@ -52,20 +49,10 @@ void
 Value::print(std::ostream& out)
 const
 {
-    if (is_null()) {
-        out << "null";
-    } else if (is_bool()) {
-        out << (get_bool_unsafe() ? "true" : "false");
-    } else if (is_num()) {
-        out << dfmt(get_num_unsafe());
-    } else if (is_ref()) {
-        get_ref_unsafe().print(out);
-    } else {
-        out << "???";
-    }
+    Value_Printer(out).print(*this);
 }
 
-auto Value::operator==(Value v) const
+auto Value::operator==(const Value& v) const
 -> bool
 {
     // Numeric equality is the fast path, so it is handled first.
@@ -75,6 +62,15 @@ auto Value::operator==(Value v) const
     if (is_num())
         return number_ == v.number_;
 
+    // A short string may be stored inline, or as a String reference value,
+    // so string equality compares the characters.
+    if (is_inline_string() || v.is_inline_string()) {
+        if (bits_ == v.bits_)
+            return true;
+        String_Ref s1(*this), s2(v);
+        return s1 && s2 && s1 == s2;
+    }
+
     if (!is_ref()) {
         // *this is a non-numeric immediate value.
         return bits_ == v.bits_;
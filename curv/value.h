@@ -52,10 +52,16 @@ struct Ref_Value : public Shared_Base
         ty_record,
         ty_module,
         ty_missing,
-        ty_lambda
+        ty_lambda,
+        ty_stream
     };
     Ref_Value(int type) : Shared_Base(), type_(type) {}
 
+    // Each subclass that can be the target of Value::dycast defines
+    //     static bool has_type(uint32_t ty);
+    // which tests the type code. This lets dycast avoid using RTTI.
+    // The test is only exact for classes that own a type code.
+
     /// Print a value like a Curv expression.
     virtual void print(std::ostream&) const = 0;
 };
@@ -81,9 +87,13 @@ struct Ref_Value : public Shared_Base
 /// the reference count, the destructor decrements the reference count and
 /// deletes the object if the refcount reaches 0.
 ///
+/// Strings of up to 6 bytes are also immediate values. They are stored in
+/// negative NaNs, which are otherwise unused: see `inline_string`.
+///
 /// Each Value has a unique bit pattern (not a given: I'm forcing the values
-/// of unused bits in the NaN box to ensure this). Only positive NaNs are used.
-/// This speeds up is_ref() and some equality tests.
+/// of unused bits in the NaN box to ensure this). Only positive NaNs are used
+/// for null, booleans and references. This speeds up is_ref() and some
+/// equality tests.
 union Value
 {
 private:
@@ -105,6 +115,11 @@ private:
     // at least 4 byte alignment). The '1' bit is 0 or 1 for false and true.
     static constexpr uint64_t k_boolbits = k_nanbits|2;
     static constexpr uint64_t k_boolmask = 0xFFFF'FFFF'FFFF'FFFE;
+    // An inline string is a negative quiet NaN. Bits 48-50 hold the length
+    // plus 1, so that the result of 0.0/0.0 on Intel (0xFFF8'0000'0000'0000)
+    // isn't mistaken for the empty string. Byte i of the string is stored
+    // in bits 8*i to 8*i+7, and unused bytes are 0.
+    static constexpr uint64_t k_strbits = 0xFFF8'0000'0000'0000;
 
     // Note: the corresponding public constructor takes a Shared argument.
     inline Value(const Ref_Value* r)
@@ -263,26 +278,90 @@ public:
         #endif
     }
 
-    /// Like dynamic_cast for a Value.
+    /// The longest string that can be stored inline in a Value.
+    static constexpr size_t k_max_inline_string = 6;
+
+    /// Construct a string of at most `k_max_inline_string` bytes, stored
+    /// inline in the Value without a heap allocation. Most code should call
+    /// `make_string_value` (in string.h) instead, which handles any length.
+    static inline Value inline_string(const char* str, size_t len) noexcept
+    {
+        Value v;
+        v.bits_ = k_strbits | (uint64_t(len + 1) << 48);
+        for (size_t i = 0; i < len; ++i)
+            v.bits_ |= uint64_t((unsigned char)str[i]) << (8*i);
+        return v;
+    }
+
+    /// True if the value is a string stored inline in the Value.
+    /// Strings may also be reference values: use `String_Ref` (string.h)
+    /// to access the characters of either kind of string.
+    inline bool is_inline_string() const noexcept
+    {
+        return bits_ > (k_strbits | 0x0000'FFFF'FFFF'FFFF);
+    }
+
+    /// Unsafe unless `is_inline_string()` is true.
+    inline size_t inline_string_size() const noexcept
+    {
+        return ((bits_ >> 48) & 7) - 1;
+    }
+
+    /// Copy the characters of an inline string into `buf`, followed by a
+    /// null terminator. `buf` must have room for k_max_inline_string+1
+    /// characters. Unsafe unless `is_inline_string()` is true.
+    inline void get_inline_string(char* buf) const noexcept
+    {
+        for (size_t i = 0; i < k_max_inline_string; ++i)
+            buf[i] = char(bits_ >> (8*i));
+        buf[k_max_inline_string] = '\0';
+    }
+
+    /// Like dynamic_cast for a Value, but returns a borrowed pointer.
+    ///
+    /// Returns nullptr if the Value isn't a T. The type test uses the
+    /// Ref_Value type code (see T::has_type), not RTTI, and no reference
+    /// count is modified. The pointer becomes invalid if the original Value
+    /// is destroyed, so use `dycast` if the result must outlive the Value.
+    ///
+    /// T must be a class that owns a distinct type code, ie it declares its
+    /// own `has_type`, or a subclass that is the only concrete type with that
+    /// code (like Module). A subclass that inherits its base's `has_type`
+    /// (like Memo_Stream) would match every value of the base type: test for
+    /// it with dynamic_cast instead.
     template <class T>
-    inline Shared<T> dycast()
+    inline T* dycast_ptr() const noexcept
     {
         if (is_ref()) {
-            T* p = dynamic_cast<T*>(&get_ref_unsafe());
-            if (p != nullptr)
-                return share(*p);
+            Ref_Value& r = get_ref_unsafe();
+            if (T::has_type(r.type_))
+                return static_cast<T*>(&r);
         }
         return nullptr;
     }
+    /// Like `to`, but returns a borrowed reference. See `dycast_ptr`.
     template <class T>
-    inline Shared<T> to(const Context& cx)
+    inline T& to_ref(const Context& cx) const
     {
-        if (is_ref()) {
-            T* p = dynamic_cast<T*>(&get_ref_unsafe());
-            if (p != nullptr)
-                return share(*p);
-        }
-        to_abort(cx, T::name);
+        T* p = dycast_ptr<T>();
+        if (p == nullptr)
+            to_abort(cx, T::name);
+        return *p;
+    }
+
+    /// Like dynamic_cast for a Value.
+    template <class T>
+    inline Shared<T> dycast() const
+    {
+        T* p = dycast_ptr<T>();
+        if (p != nullptr)
+            return share(*p);
+        return nullptr;
+    }
+    template <class T>
+    inline Shared<T> to(const Context& cx) const
+    {
+        return share(to_ref<T>(cx));
     }
     static void to_abort [[noreturn]] (const Context&, const char*);
 
@@ -334,8 +413,8 @@ public:
     /// Print a value like a Curv expression.
     void print(std::ostream&) const;
 
-    bool operator==(Value) const;
-    bool operator!=(Value v) const { return !(*this == v); }
+    bool operator==(const Value&) const;
+    bool operator!=(const Value& v) const { return !(*this == v); }
 };
 
 /// Special marker that denotes the absence of a value
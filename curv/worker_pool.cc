@@ -0,0 +1,134 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#include <curv/worker_pool.h>
+#include <curv/shared.h>
+#include <curv/trace.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace curv {
+
+static std::atomic<unsigned> eval_threads_{
+    std::max(1u, std::thread::hardware_concurrency())};
+
+unsigned
+eval_threads()
+{
+    return eval_threads_.load(std::memory_order_relaxed);
+}
+
+void
+set_eval_threads(unsigned n)
+{
+    eval_threads_ = std::max(1u, n);
+}
+
+namespace {
+
+struct Worker_Pool
+{
+    std::mutex mutex_;
+    std::condition_variable wake_;  // a job was posted, or shutdown
+    std::condition_variable idle_;  // running_ dropped to 0
+    std::vector<std::thread> threads_;
+    const std::function<void(bool)>* job_ = nullptr;
+    std::uint64_t generation_ = 0;  // incremented for each job
+    unsigned wanted_ = 0;           // number of workers the job can use
+    unsigned taken_ = 0;            // number of workers that joined the job
+    unsigned running_ = 0;          // number of workers still in the job
+    bool shutdown_ = false;
+
+    ~Worker_Pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : threads_)
+            t.join();
+    }
+
+    void worker()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::uint64_t seen = generation_;
+        for (;;) {
+            wake_.wait(lock, [&]() {
+                return shutdown_ || (job_ != nullptr && generation_ != seen);
+            });
+            if (shutdown_)
+                return;
+            seen = generation_;
+            if (taken_ >= wanted_)
+                continue;
+            ++taken_;
+            ++running_;
+            auto job = job_;
+            lock.unlock();
+            {
+                Trace_Scope trace("worker job");
+                (*job)(true);
+            }
+            lock.lock();
+            if (--running_ == 0)
+                idle_.notify_all();
+        }
+    }
+
+    // Called with mutex_ locked.
+    void start_threads(unsigned n)
+    {
+        try {
+            while (threads_.size() < n)
+                threads_.emplace_back([this]() { worker(); });
+        } catch (...) {
+            // Can't start another thread: carry on with the ones we have.
+        }
+    }
+};
+
+} // namespace
+
+void
+run_on_workers(const std::function<void(bool)>& work)
+{
+    unsigned nworkers = eval_threads() - 1;
+    if (nworkers == 0) {
+        work(false);
+        return;
+    }
+    static Worker_Pool pool;
+    // Refcounts must be atomic before a worker can see the job.
+    Atomic_Refcount_Scope atomic_refcounts;
+    bool busy;
+    {
+        std::lock_guard<std::mutex> lock(pool.mutex_);
+        busy = pool.job_ != nullptr || pool.running_ != 0;
+        if (!busy) {
+            pool.start_threads(nworkers);
+            pool.job_ = &work;
+            ++pool.generation_;
+            pool.wanted_ = nworkers;
+            pool.taken_ = 0;
+        }
+    }
+    if (busy) {
+        work(false);
+        return;
+    }
+    pool.wake_.notify_all();
+    work(false);
+    std::unique_lock<std::mutex> lock(pool.mutex_);
+    pool.job_ = nullptr;
+    pool.idle_.wait(lock, [&]() { return pool.running_ == 0; });
+}
+
+} // namespace curv
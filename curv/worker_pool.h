@@ -0,0 +1,30 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef CURV_WORKER_POOL_H
+#define CURV_WORKER_POOL_H
+
+#include <functional>
+
+namespace curv {
+
+/// The number of threads, including the calling thread, used to evaluate
+/// independent module definitions in parallel (see Scope_Executable).
+/// The default is the number of hardware threads. 1 means serial evaluation.
+unsigned eval_threads();
+void set_eval_threads(unsigned);
+
+/// Call `work(false)` on the current thread, and `work(true)` concurrently
+/// on up to eval_threads()-1 idle worker threads, then wait for all of the
+/// calls to return. `work` must not throw. The worker threads are started
+/// on first use, and are reused.
+///
+/// Only one job runs at a time: if the pool is busy, for example because
+/// run_on_workers is called from inside `work`, then `work` is only called
+/// on the current thread. Reference counts are updated atomically until
+/// all of the calls have returned.
+void run_on_workers(const std::function<void(bool)>& work);
+
+} // namespace curv
+#endif // header guard
@@ -9,6 +9,7 @@
 #include <curv/phrase.h>
 #include <curv/string.h>
 #include <curv/system.h>
+#include <curv/worker_pool.h>
 
 using namespace std;
 using namespace curv;
@@ -215,6 +216,8 @@ TEST(curv, eval)
     SUCCESS("\"abc\"", "\"abc\"");
     SUCCESS("[1,2,3]", "[1,2,3]");
     SUCCESS("{x:1}", "{x:1}");
+    SUCCESS("{\"a\":-1, b:[-2,+3,\"x\"], c:()}", "{a:-1,b:[-2,3,\"x\"],c:[]}");
+    SUCCESS("let x=1 in {\"a$(x)\":-x, b:[-2,x]}", "{a1:-1,b:[-2,1]}");
 
     // builtins
     SUCCESS("pi",  "3.141592653589793");
@@ -249,10 +252,25 @@ TEST(curv, eval)
         "     ^--");
     SUCCESS("count()", "0");
     FAILALL("count 0",
-        "not a list or string\n"
+        "not a list, string or stream\n"
         "line 1(column 7)\n"
         "  count 0\n"
         "        ^");
+    SUCCESS("let s=unfold(0, n->[n,n+1]) in [count(take(3,s)), s[4], s[[1,2]]]",
+        "[3,4,[1,2]]");
+    SUCCESS("let s=memo(lazy_map(x->x*x, 1..4)) in [for (x in s) x, count s]",
+        "[1,4,9,16,4]");
+    // A memoized stream calls the mapped function once per element,
+    // however many times it is iterated or indexed.
+    SUCCESS("let s=memo(lazy_map(x->(do print \"f $(x)\" in x*x), 1..3))"
+            " in [for (x in s) x, for (x in s) x, s[1]]",
+        "[1,4,9,1,4,9,4]");
+    EXPECT_EQ(console.str(), "f 1\nf 2\nf 3\n");
+    SUCCESS("let s=memo(unfold(0, n->(do print \"u $(n)\" in [n,n+1])))"
+            " in [s[2], s[1], count(take(3,s))]",
+        "[2,1,3]");
+    EXPECT_EQ(console.str(), "u 0\nu 1\nu 2\n");
+    SUCCESS("[for (x in lazy_filter(x->x>1, take(4,[1,2,3]))) x]", "[2,3]");
     SUCCESS("true||false", "true");
     SUCCESS("false||true", "true");
     SUCCESS("false||false", "false");
@@ -291,6 +309,10 @@ TEST(curv, eval)
     SUCCESS("1 > 0", "true");
     SUCCESS("1 >= 0", "true");
     SUCCESS("{f:sqrt}.f(4)", "2");
+    SUCCESS("{include {a:1,b:2}; c = a + b}", "{a:1,b:2,c:3}");
+    SUCCESS("let include {a:1}; f x = x + a; in f 2", "3");
+    SUCCESS("count(fields {include {a:1,b:2}; c = 3})", "3");
+    FAILMSG("{include {a:1}; a = 2}", "a: multiply defined");
     SUCCESS("4^0.5", "2");
     SUCCESS("4^-1", "0.25");
     SUCCESS("-2^2", "-4");
@@ -476,3 +498,97 @@ TEST(curv, eval)
     FAILMSG("do a=2 in a", "wrong style of definition for this block");
   }
 }
+
+// A module value must not be reachable from its own slots,
+// otherwise reference counting can't reclaim it. See ideas/compiler/Leak.md.
+TEST(curv, module_cycle)
+{
+    const char* sources[] = {
+        "{f x = x; a = f}",
+        "{reduce(first,f) rest = if (rest==[]) first else "
+            "reduce(f(first,rest[0]), f) (rest[1..<count rest]); "
+            "sum = reduce(0, (x,y)->x+y); s = sum[1,2,3]}",
+        "{h x = if (x<=0) 0 else k(x-1); k x = h x; p = [h,k]; r = {q: h}}",
+    };
+    for (auto src : sources) {
+        auto script = make<CString_Script>("", src);
+        Value val;
+        {
+            curv::Program prog{*script, make_system()};
+            prog.compile();
+            val = prog.eval();
+        }
+        ASSERT_TRUE(val.is_ref()) << src;
+        EXPECT_EQ(val.get_ref_unsafe().use_count, 1u) << src;
+    }
+}
+
+// CURV_TEST_PLUGIN is the path of the plugin built from tests/plugin/twice.cc.
+TEST(curv, plugin)
+{
+    std::stringstream plugin_console;
+    System_Impl sys(plugin_console);
+    sys.load_plugin(make_string(CURV_TEST_PLUGIN));
+
+    auto script = make<CString_Script>("", "twice 21");
+    Program prog{*script, sys};
+    prog.compile();
+    EXPECT_EQ(prog.eval(), Value{42.0});
+
+    EXPECT_THROW(sys.load_plugin(make_string("no_such_plugin.so")), Exception);
+}
+
+TEST(curv, budget)
+{
+    auto& sys = make_system();
+    auto eval = [&](const char* src) -> Value {
+        auto script = make<CString_Script>("", src);
+        curv::Program prog{*script, sys};
+        prog.compile();
+        return prog.eval();
+    };
+    {
+        Budget budget(10'000, 0);
+        Budget_Scope scope(budget);
+        EXPECT_EQ(eval("sum[1,2,3]"), Value{6.0});
+        EXPECT_THROW(eval("do var i := 0; while (true) i := i + 1; in i"),
+            Exception);
+        EXPECT_THROW(eval("let f x = f x in f 0"), Exception);
+    }
+    {
+        Budget budget(0, 1'000'000);
+        Budget_Scope scope(budget);
+        EXPECT_THROW(eval("count(1..1e8)"), Exception);
+    }
+    EXPECT_EQ(eval("count(1..1e6)"), Value{1e6});
+}
+
+// Independent definitions in a module are evaluated in parallel.
+// The result, and the error reported, are the same as for serial evaluation.
+TEST(curv, parallel_module)
+{
+    unsigned saved = eval_threads();
+    set_eval_threads(4);
+    SUCCESS("{f n = sum[for (i in 0..<n) i]; a = f 1000; b = f 2000; "
+            "c = a + b; d = [a, b]}",
+        "{a:499500,b:1999000,c:2498500,d:[499500,1999000],f:<function>}");
+    FAILMSG("{f n = sum[for (i in 0..<n) i]; a = f 1000; "
+            "b = if (f 2000 > 0) error \"b\" else 0; c = error \"c\"}",
+        "b");
+    // b comes before c in serial order, but is in a later wave.
+    FAILMSG("{a = sum[for (i in 0..<1000) i]; "
+            "b = if (a > x) error \"b\" else a; x = 1; c = error \"c\"}",
+        "b");
+    set_eval_threads(saved);
+}
+
+// A transformation or union of a shape whose dist was replaced, using
+// `make_shape {...s, dist: f}`, uses the new dist, not the construction
+// fields (eg, `affine`) spread from `s`.
+TEST(curv, shape_override)
+{
+    SUCCESS("let s = cube 2 >> move(5,0,0); u = make_shape {...s, dist p: 42}"
+            " in [(u >> move(1,0,0)).dist(0,0,0,0),"
+            " (union[u, cube 1] >> move(1,0,0)).dist(100,0,0,0)]",
+        "[42,42]");
+}
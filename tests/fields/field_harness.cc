@@ -0,0 +1,232 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+// Speed benchmark and conformance harness for CPU distance field evaluators.
+//
+// usage: field_harness [-n npoints] [-t tolerance] std.curv [file.curv...]
+//
+// Each shape in the std namespace, and each file argument that evaluates
+// to a shape, is sampled at the same random points by every backend in
+// `backends`. For each shape and backend, we report points per second.
+//
+// There is only one backend so far, so this is a benchmark. Once there are
+// more, the first backend is the reference, and we also report the maximum
+// absolute difference from the reference. Exit status is 1 if any backend
+// diverges from the reference by more than the tolerance (a NaN on one side
+// only counts as an infinite difference), or fails where the reference
+// succeeded.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <curv/builtin.h>
+#include <curv/context.h>
+#include <curv/exception.h>
+#include <curv/file.h>
+#include <curv/program.h>
+#include <curv/shape.h>
+#include <curv/system.h>
+
+using namespace curv;
+
+// A CPU evaluator for the `dist` function of a shape.
+// To add a backend, subclass this and add it to `make_backends`.
+struct Field_Backend
+{
+    const char* name_;
+    Field_Backend(const char* name) : name_(name) {}
+    virtual ~Field_Backend() {}
+
+    // Prepare to evaluate the shape. Return false if the backend
+    // doesn't support it: that is reported, but isn't a failure.
+    virtual bool prepare(Shape_Recognizer&) = 0;
+
+    virtual double dist(double x, double y, double z, double t) = 0;
+};
+
+// The tree walking interpreter: calls the `dist` closure in the evaluator.
+struct Tree_Backend : public Field_Backend
+{
+    Shape_Recognizer* shape_ = nullptr;
+    Tree_Backend() : Field_Backend("tree") {}
+    virtual bool prepare(Shape_Recognizer& shape) override
+    {
+        shape_ = &shape;
+        return true;
+    }
+    virtual double dist(double x, double y, double z, double t) override
+    {
+        return shape_->dist(x, y, z, t);
+    }
+};
+
+std::vector<std::unique_ptr<Field_Backend>>
+make_backends()
+{
+    std::vector<std::unique_ptr<Field_Backend>> b;
+    b.emplace_back(new Tree_Backend());
+    return b;
+}
+
+struct Test_Case
+{
+    std::string name_;
+    Value shape_;
+};
+
+struct Point { double x, y, z; };
+
+// Sample points uniformly from the bounding box, enlarged by 10% so that
+// the exterior is covered. Infinite bounds are clamped to ±10.
+std::vector<Point>
+sample_points(const Shape_Recognizer& shape, int npoints, std::mt19937& rng)
+{
+    auto range = [&](double lo, double hi) {
+        if (!std::isfinite(lo)) lo = -10.0;
+        if (!std::isfinite(hi)) hi = 10.0;
+        double margin = 0.1 * (hi - lo);
+        return std::uniform_real_distribution<double>(lo-margin, hi+margin);
+    };
+    auto xr = range(shape.bbox_.xmin, shape.bbox_.xmax);
+    auto yr = range(shape.bbox_.ymin, shape.bbox_.ymax);
+    auto zr = range(shape.bbox_.zmin, shape.bbox_.zmax);
+    std::vector<Point> points(npoints);
+    for (auto& p : points)
+        p = {xr(rng), yr(rng), shape.is_3d_ ? zr(rng) : 0.0};
+    return points;
+}
+
+// A NaN on only one side is an infinite difference, so that it is reported
+// as a divergence (std::max would discard a NaN difference).
+double
+difference(double a, double b)
+{
+    if (a == b || (std::isnan(a) && std::isnan(b)))
+        return 0.0;
+    if (std::isnan(a) || std::isnan(b))
+        return INFINITY;
+    return std::abs(a - b);
+}
+
+int
+main(int argc, char** argv)
+{
+    int npoints = 1000;
+    double tolerance = 1e-9;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:t:")) != -1) {
+        switch (opt) {
+        case 'n':
+            npoints = atoi(optarg);
+            break;
+        case 't':
+            tolerance = atof(optarg);
+            break;
+        default:
+            std::cerr << "usage: " << argv[0]
+                << " [-n npoints] [-t tolerance] std.curv [file.curv...]\n";
+            return 2;
+        }
+    }
+    if (optind >= argc || npoints < 1) {
+        std::cerr << "usage: " << argv[0]
+            << " [-n npoints] [-t tolerance] std.curv [file.curv...]\n";
+        return 2;
+    }
+
+    System_Impl sys(std::cerr);
+    Context cx;
+    std::vector<Test_Case> cases;
+    try {
+        sys.load_library(make_string(argv[optind]));
+    } catch (Exception& e) {
+        std::cerr << "ERROR: " << e << "\n";
+        return 2;
+    }
+
+    // std.curv primitives that are shapes, in a reproducible order.
+    for (auto& b : sys.std_namespace()) {
+        auto bv = dynamic_cast<const Builtin_Value*>(&*b.second);
+        if (bv == nullptr) continue;
+        Shape_Recognizer shape(cx, sys);
+        if (shape.recognize(bv->value_))
+            cases.push_back({stringify("std.",b.first)->c_str(), bv->value_});
+    }
+    std::sort(cases.begin(), cases.end(),
+        [](const Test_Case& a, const Test_Case& b) { return a.name_<b.name_; });
+
+    for (int i = optind+1; i < argc; ++i) {
+        try {
+            auto file = make<File_Script>(make_string(argv[i]), Context{});
+            Program prog{*file, sys};
+            prog.compile();
+            Value val = prog.eval();
+            Shape_Recognizer shape(cx, sys);
+            if (shape.recognize(val))
+                cases.push_back({argv[i], val});
+        } catch (Exception& e) {
+            std::cerr << argv[i] << ": skipped: " << e.what() << "\n";
+        }
+    }
+
+    auto backends = make_backends();
+    bool failed = false;
+    std::mt19937 rng(0);
+    printf("%-40s %-10s %14s %12s\n", "shape", "backend", "points/s", "max diff");
+    for (auto& c : cases) {
+        Shape_Recognizer shape(cx, sys);
+        shape.recognize(c.shape_);
+        auto points = sample_points(shape, npoints, rng);
+        std::vector<double> reference;
+        for (auto& be : backends) {
+            if (!be->prepare(shape)) {
+                printf("%-40s %-10s %14s\n", c.name_.c_str(), be->name_,
+                    "unsupported");
+                continue;
+            }
+            std::vector<double> result(points.size());
+            auto start = std::chrono::steady_clock::now();
+            try {
+                for (size_t i = 0; i < points.size(); ++i) {
+                    auto& p = points[i];
+                    result[i] = be->dist(p.x, p.y, p.z, 0.0);
+                }
+            } catch (Exception& e) {
+                printf("%-40s %-10s %14s\n", c.name_.c_str(), be->name_,
+                    "error");
+                std::cerr << c.name_ << ": " << e.what() << "\n";
+                if (&be == &backends.front())
+                    break;
+                failed = true;
+                continue;
+            }
+            auto end = std::chrono::steady_clock::now();
+            double secs = std::chrono::duration<double>(end - start).count();
+            if (reference.empty()) {
+                reference = result;
+                printf("%-40s %-10s %14.0f %12s\n", c.name_.c_str(),
+                    be->name_, points.size() / secs, "reference");
+                continue;
+            }
+            double maxdiff = 0.0;
+            for (size_t i = 0; i < result.size(); ++i)
+                maxdiff = std::max(maxdiff,
+                    difference(result[i], reference[i]));
+            bool diverged = !(maxdiff <= tolerance);
+            printf("%-40s %-10s %14.0f %12.3g%s\n", c.name_.c_str(),
+                be->name_, points.size() / secs, maxdiff,
+                diverged ? "  DIVERGED" : "");
+            failed = failed || diverged;
+        }
+    }
+    return failed ? 1 : 0;
+}
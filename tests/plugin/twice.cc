@@ -0,0 +1,35 @@
+// Copyright 2016-2018 Doug Moen
+// Licensed under the Apache License, version 2.0
+// See accompanying file LICENSE or https://www.apache.org/licenses/LICENSE-2.0
+
+// A minimal native plugin, used by TEST(curv, plugin) in tests/eval.cc.
+
+#include <curv/arg.h>
+#include <curv/exception.h>
+#include <curv/gl_context.h>
+#include <curv/plugin.h>
+
+using namespace curv;
+
+struct Twice_Function : public Polyadic_Function
+{
+    Twice_Function() : Polyadic_Function(1) {}
+    Value call(Frame& args) override
+    {
+        return {2.0 * args[0].to_num(At_Arg(args))};
+    }
+    GL_Value gl_call(GL_Frame& f) const override
+    {
+        auto arg = f[0];
+        if (arg.type != GL_Type::Num)
+            throw Exception(At_GL_Arg(0, f), "twice: argument is not a number");
+        auto result = f.gl.newvalue(GL_Type::Num);
+        f.gl.out << "  float "<<result<<" = 2.0*"<<arg<<";\n";
+        return result;
+    }
+};
+
+CURV_PLUGIN_INIT(names)
+{
+    names["twice"] = make<Builtin_Value>(Value{make<Twice_Function>()});
+}
@@ -2,6 +2,8 @@
 #include <curv/value.h>
 #include <curv/function.h>
 #include <curv/string.h>
+#include <curv/list.h>
+#include <curv/printer.h>
 #include <sstream>
 #include <iostream>
 using namespace curv;
@@ -95,6 +97,25 @@ TEST(curv, value)
     EXPECT_FALSE(v.is_ref());
     EXPECT_TRUE(prints_as(v, "null"));
 
+    // integer fast path in Value_Printer agrees with dtostr
+    EXPECT_TRUE(prints_as(Value(-42.0), "-42"));
+    EXPECT_TRUE(prints_as(Value(1000.0), "1000"));
+    EXPECT_TRUE(prints_as(Value(10000.0), "1e4"));
+    EXPECT_TRUE(prints_as(Value(12345000.0), "12345000"));
+    EXPECT_TRUE(prints_as(Value(1e20), "1e20"));
+
+    {
+        auto list = List::make(100);
+        for (size_t i = 0; i < list->size(); ++i)
+            (*list)[i] = Value(double(i));
+        std::stringstream ss;
+        Value_Printer pr(ss, 10);
+        pr.print(Value{Shared<List>(std::move(list))});
+        pr.flush();
+        EXPECT_TRUE(pr.truncated());
+        EXPECT_EQ(ss.str(), "[0,1,2,3,4...");
+    }
+
     auto ptr = String::make("abc", 3);
     EXPECT_TRUE(ptr->use_count == 1);
     v = Value(ptr);
@@ -107,6 +128,30 @@ TEST(curv, value)
     ptr = nullptr;
     EXPECT_TRUE(v.get_ref_unsafe().use_count == 1);
 
+    // short strings are stored inline, and compare equal to Strings
+    v = make_string_value("abc", 3);
+    EXPECT_TRUE(v.is_inline_string());
+    EXPECT_FALSE(v.is_null());
+    EXPECT_FALSE(v.is_num());
+    EXPECT_FALSE(v.is_ref());
+    EXPECT_TRUE(prints_as(v, "\"abc\""));
+    EXPECT_TRUE(v == Value{String::make("abc", 3)});
+    EXPECT_TRUE(Value{String::make("abc", 3)} == v);
+    EXPECT_FALSE(v == make_string_value("abd", 3));
+    EXPECT_FALSE(v == Value{});
+    {
+        String_Ref str(v);
+        ASSERT_TRUE(bool(str));
+        EXPECT_EQ(str.size(), 3u);
+        EXPECT_STREQ(str.c_str(), "abc");
+        EXPECT_FALSE(bool(String_Ref(Value{1.0})));
+    }
+    EXPECT_TRUE(make_string_value("", 0).is_inline_string());
+    EXPECT_FALSE(make_string_value("", 0) == Value{});
+    EXPECT_TRUE(make_string_value("abcdef", 6).is_inline_string());
+    EXPECT_TRUE(make_string_value("abcdefg", 7).is_ref());
+    EXPECT_TRUE(Value(0.0/0.0).is_null());
+
 #if 0
     v = make_ref_value<Ref_Value>(17);
     EXPECT_FALSE(v.is_null());